@@ -9,8 +9,13 @@
  * hardcoded for task sets with exactly four tasks. Combinations and
  * permutations are generated with deep nested loops instead of with more
  * elegant (but more complicated) methods. To avoid any extra complexity, this
- * program is also single-threaded, despite the inherent parallelism that is
- * possible when testing vast numbers of configurations.
+ * program is single-threaded by default, despite the inherent parallelism that
+ * is possible when testing vast numbers of configurations. A parallel search
+ * over the priority permutations can be enabled with the -j option, in which
+ * case each worker thread tests whole permutations on its own copy of the
+ * task set, using exactly the same code as the single-threaded search. The
+ * "search" command runs a separate, generic search for other numbers of tasks,
+ * which can be checked against the naive search with the "selfcheck" command.
  *
  * This program should compile on any standards-compliant C99 compiler. High
  * compiler optimization settings (e.g., -O3 for gcc, clang) are recommended.
@@ -24,13 +29,52 @@
  * Last updated on February 5, 2019.
  */
 
-#include <stdio.h>  /* For printf() */
-#include <stdlib.h> /* For exit() and atoi() */
-#include <assert.h> /* For assert() */
+#define _POSIX_C_SOURCE 200809L /* For POSIX threads */
+
+#include <stdio.h>   /* For printf() */
+#include <stdlib.h>  /* For exit(), atoi() and malloc() */
+#include <string.h>  /* For strcmp() */
+#include <assert.h>  /* For assert() */
+#include <limits.h>  /* For LONG_MAX */
+#include <stdint.h>  /* For uint8_t */
+#ifdef __AVX2__
+#include <immintrin.h> /* For the AVX2 version of simulate_sas_batch() */
+#endif
+#include <time.h>    /* For time() and clock_gettime() */
+#include <pthread.h> /* For the parallel search (-j option) */
+#include <unistd.h>  /* For fsync() and close() */
+#include <fcntl.h>   /* For open() */
+#include <sys/stat.h> /* For fstat() */
+#include <sys/mman.h> /* For mmap() */
 
 #define VERBOSE   0 /* Set to 1 for lots of output (will run MUCH slower) */
 #define NUM_TASKS 4 /* Warning: WILL break for other values than 4 */
 
+#define MAX_THREADS 1024 /* Upper limit for the -j option */
+#define MAX_PERMUTATIONS (8*7*6*5*4*3*2*1) /* Of the 8 priority values */
+
+#ifndef GEN_TASKS
+#define GEN_TASKS 4 /* Number of tasks in the generic search (see Makefile) */
+#endif
+
+#ifndef INSTRUMENT
+#define INSTRUMENT 0 /* Set to 1 to count simulations (see Makefile) */
+#endif
+
+#ifndef SPECIALIZE
+#define SPECIALIZE 0 /* Set to 1 for specialized simulators (see Makefile) */
+#endif
+
+#ifndef OPENCL
+#define OPENCL 0 /* Set to 1 for the gpu engine (see Makefile) */
+#endif
+#if OPENCL
+#define CL_TARGET_OPENCL_VERSION 120
+#include <CL/cl.h>   /* For the gpu engine (-e gpu option) */
+#endif
+
+#define MISS_TIME_BUCKETS 32 /* Bucket b counts misses in [2^(b-1), 2^b) */
+
 struct task_t {
 	/* Fixed task parameters */
 	int wcet;
@@ -44,11 +88,205 @@ struct task_t {
 	/* Simulation state */
 	long last_release_time; /* Time point of the task's last job release */
 	int remaining_wcet;     /* Remaining execution of the task's last job */
+	long min_phase_2_age;   /* Smallest age of an active job in phase 2 */
+};
+
+/*
+ * Instrumentation counters of the simulations of a task set, only kept when
+ * compiled with INSTRUMENT set to 1.
+ */
+struct counters_t {
+	long simulations;         /* Simulations by the single-run engines */
+	long batched_simulations; /* Lanes simulated by simulate_sas_batch() */
+	long ticks;               /* Time points covered by the simulations */
+	long misses_by_task[NUM_TASKS];
+	long misses_at_time[MISS_TIME_BUCKETS]; /* Histogram of the miss times */
 };
 
 struct taskset_t {
 	struct task_t tasks[NUM_TASKS];
 	long hyper_period;
+#if INSTRUMENT
+	struct counters_t counters;
+#endif
+};
+
+/*
+ * Saved simulation state of the SAS at time point t, after the job releases at
+ * t but before the scheduling decision at t. The phase change points are those
+ * that were used in the simulation. A negative t means that nothing is saved.
+ */
+struct snapshot_t {
+	long t;
+	long last_release_time[NUM_TASKS];
+	int remaining_wcet[NUM_TASKS];
+	long min_phase_2_age[NUM_TASKS];
+	int phase_change_point[NUM_TASKS];
+};
+
+/*
+ * Snapshots of the SAS saved for the incremental FDMS policy (-s option), in
+ * order of time. For each task i and each age q below its phase change point,
+ * snapshots[first[i][q]] is a state at or before the first time point at which
+ * task i has an active job of age q. Only the first recorded[i] ages of task i
+ * have a snapshot.
+ */
+struct fdms_snapshots_t {
+	struct snapshot_t *snapshots;
+	long num_snapshots;
+	long *first[NUM_TASKS];
+	long recorded[NUM_TASKS];
+	long next_time; /* No new age can be reached before this time point */
+};
+
+/*
+ * Compact copy of a task set for the hot loop of simulate_sas_compact(), with
+ * the parameters of all tasks in small arrays of the narrowest type that fits.
+ * Requires that all periods are at most COMPACT_MAX_PERIOD.
+ */
+#define COMPACT_MAX_PERIOD 254 /* So that ages and times fit in a uint8_t */
+
+struct compact_taskset_t {
+	uint8_t wcet[NUM_TASKS];
+	uint8_t period[NUM_TASKS];
+	uint8_t phase_1_prio[NUM_TASKS];
+	uint8_t phase_2_prio[NUM_TASKS];
+	uint8_t phase_change_point[NUM_TASKS];
+	long hyper_period;
+	long end_time; /* Where simulate_sas_compact() stopped, for counters */
+};
+
+/*
+ * Position of a worker in the search: the priority permutation it tests, the
+ * combination of phase change points at which it is (or will start), and the
+ * end of its chunk of phase change points of T1. All combinations of the chunk
+ * before this one in the order of the nested loops in
+ * test_all_phase_change_points() have been tested. With the --order option,
+ * these are positions in the order instead of phase change points.
+ */
+struct cursor_t {
+	long permutation;                  /* Index in the table, -1 if none */
+	int phase_change_point[NUM_TASKS]; /* T4's is always 0 */
+	int end; /* The chunk has T1's phase change points below this */
+};
+
+/*
+ * Order in which test_all_phase_change_points_ordered() tests the phase change
+ * points of the tasks (--order option): the k-th one of task i is pcps[i][k].
+ */
+struct pcp_order_t {
+	int *pcps[NUM_TASKS];
+};
+
+/*
+ * Number of combinations of phase change points checked and rejected by each
+ * prefilter (see the -f and -m options), and the use of the memo cache.
+ */
+#define NUM_PREFILTERS 4
+
+struct prefilter_stats_t {
+	long checked[NUM_PREFILTERS];
+	long rejected[NUM_PREFILTERS];
+	long memo_lookups;
+	long memo_hits;
+	long memo_evictions;
+};
+
+/*
+ * One assignment of phase 1 and phase 2 priorities to the tasks.
+ */
+struct prio_permutation_t {
+	int phase_1_prio[NUM_TASKS];
+	int phase_2_prio[NUM_TASKS];
+};
+
+/*
+ * The available engines for simulating the SAS.
+ */
+enum engine_t {
+	ENGINE_TICK,  /* simulate_sas(), advances time by one unit per step */
+	ENGINE_EVENT, /* simulate_sas_event_driven(), jumps between events */
+	ENGINE_COMPACT, /* simulate_sas_compact(), narrow per-task arrays */
+	ENGINE_TABLE, /* simulate_sas_table(), table lookup of the running task */
+	ENGINE_SIMD,  /* simulate_sas_batch(), many phase change points at once */
+	ENGINE_COUNTDOWN, /* simulate_countdown(), counts down to releases */
+	ENGINE_GPU,   /* simulate_sas_gpu(), all of T2..T4's at once on a GPU */
+};
+
+/*
+ * Orders in which the search tests the phase change points (--order option).
+ */
+enum order_t {
+	ORDER_UP,     /* From 0 up to the period, as in the naive loops */
+	ORDER_CENTER, /* Outwards from half the period */
+	ORDER_RANKED, /* Outwards from both the WCET and half the period */
+	ORDER_FDMS,   /* Outwards from the phase change points of FDMS */
+};
+
+/*
+ * How much the searches print (--output option).
+ */
+enum output_t {
+	OUTPUT_SILENT,   /* Only the final verdict */
+	OUTPUT_PROGRESS, /* Periodic progress summaries and witnesses (default) */
+	OUTPUT_FULL,     /* Every permutation, as in the original program */
+};
+
+/*
+ * Settings given on the command line.
+ */
+struct options_t {
+	int num_threads;      /* Worker threads in the permutation search */
+	enum engine_t engine; /* Simulator used for the SAS */
+	int prune;            /* Skip phase change points that give the same miss */
+	int snapshots;        /* Resume simulations from saved schedule prefixes */
+	int prefilter;        /* Reject some combinations without simulating */
+	int memoize;          /* Reject by cached verdicts of top task subsets */
+	int bisect;           /* Bisect instead of testing all phase change pts */
+	enum order_t order;   /* Order of the phase change points of each task */
+	int numa_local;       /* Pad the worker contexts to whole pages */
+	int trace;            /* Record a schedule trace in simulate_sas() */
+	int trace_buffer_size; /* MiB of the ring buffer of the trace */
+	long max_hyper_period; /* Longest hyper-period to simulate, 0 if any */
+	int unique;           /* Only test one of each class of equivalent perms */
+	int steal;            /* Idle workers split the chunks of other workers */
+	char *checkpoint_file;   /* File for periodic checkpoints, or NULL */
+	int checkpoint_interval; /* Seconds between checkpoints */
+	char *resume_file;       /* Checkpoint to resume from, or NULL */
+	int shard;               /* Only test permutations i with */
+	int num_shards;          /* i % num_shards == shard */
+	enum output_t output;    /* What the searches print */
+	int progress_interval;   /* Seconds between progress summaries */
+	char *json_file;         /* JSON lines result stream file, or NULL */
+	char *status_file;       /* Status report file ("-" for stderr), or NULL */
+	char *metrics_file;      /* Prometheus metrics file, or NULL */
+};
+
+struct options_t options = {
+	1,           /* num_threads */
+	ENGINE_TICK, /* engine */
+	0,           /* prune */
+	0,           /* snapshots */
+	0,           /* prefilter */
+	0,           /* memoize */
+	0,           /* bisect */
+	ORDER_UP,    /* order */
+	0,           /* numa_local */
+	0,           /* trace */
+	64,          /* trace_buffer_size */
+	0,           /* max_hyper_period */
+	0,           /* unique */
+	0,           /* steal */
+	NULL,        /* checkpoint_file */
+	60,          /* checkpoint_interval */
+	NULL,        /* resume_file */
+	0,           /* shard */
+	1,           /* num_shards */
+	OUTPUT_PROGRESS, /* output */
+	10,          /* progress_interval */
+	NULL,        /* json_file */
+	NULL,        /* status_file */
+	NULL,        /* metrics_file */
 };
 
 /*
@@ -67,10 +305,50 @@ long gcd(long a, long b) {
 	return a;
 }
 
+/*
+ * Multiply the non-negative a and b, saturating at LONG_MAX instead of
+ * overflowing.
+ */
+long saturating_mul(long a, long b) {
+	if (a != 0 && b > LONG_MAX / a) {
+		return LONG_MAX;
+	}
+	return a * b;
+}
+
+/*
+ * Get the least common multiple of the positive a and b, or LONG_MAX if it
+ * does not fit in a long.
+ */
 long lcm(long a, long b) {
-	return a / gcd(a, b) * b; 
+	return saturating_mul(a / gcd(a, b), b);
+}
+
+/*
+ * Allocate memory, exiting the program if no memory is available.
+ */
+void *xmalloc(size_t size) {
+	void *p = malloc(size);
+	if (p == NULL) {
+		fprintf(stderr, "Out of memory.\n");
+		exit(EXIT_FAILURE);
+	}
+	return p;
+}
+
+/*
+ * Get the time in seconds from some fixed point in the past.
+ */
+double get_seconds() {
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec + now.tv_nsec * 1e-9;
 }
 
+/*
+ * Get the hyper-period of the task set, or LONG_MAX if it does not fit in a
+ * long.
+ */
 long hyper_period(struct taskset_t *ts) {
 	long hp = 1;
 	for (int i = 0; i < NUM_TASKS; i++) {
@@ -79,6 +357,46 @@ long hyper_period(struct taskset_t *ts) {
 	return hp;
 }
 
+/*
+ * Get the number of combinations of phase change points of the task set, or
+ * LONG_MAX if it does not fit in a long.
+ */
+long count_combinations(struct taskset_t *ts) {
+	long combinations = 1;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		combinations = saturating_mul(combinations,
+				ts->tasks[i].period + 1L);
+	}
+	return combinations;
+}
+
+/*
+ * Check that a task set with the hyper-period can be simulated: that the
+ * hyper-period fits in a long (so that every time point up to one past it
+ * does), and that it is at most options.max_hyper_period (--max-hyper-period
+ * option) if that is set.
+ */
+int is_within_horizon(long hyper_period) {
+	return hyper_period < LONG_MAX && (options.max_hyper_period == 0 ||
+			hyper_period <= options.max_hyper_period);
+}
+
+/*
+ * Exit the program if a task set with the hyper-period cannot be simulated
+ * (see is_within_horizon()).
+ */
+void exit_if_beyond_horizon(long hyper_period) {
+	if (hyper_period == LONG_MAX) {
+		fprintf(stderr, "The hyper-period of the task set is too long.\n");
+		exit(EXIT_FAILURE);
+	} else if (!is_within_horizon(hyper_period)) {
+		fprintf(stderr, "The hyper-period %ld of the task set exceeds "
+				"--max-hyper-period %ld.\n", hyper_period,
+				options.max_hyper_period);
+		exit(EXIT_FAILURE);
+	}
+}
+
 /*
  * Print the task set. Also prints current priority settings and phase change
  * points if print_prios and print_phase_change_points are true.
@@ -116,6 +434,7 @@ void reset_simulation_state(struct taskset_t *ts) {
 	for (int i = 0; i < NUM_TASKS; i++) {
 		ts->tasks[i].last_release_time = -1; /* -1 means never released */
 		ts->tasks[i].remaining_wcet = -1;
+		ts->tasks[i].min_phase_2_age = LONG_MAX; /* Never active in phase 2 */
 	}
 }
 
@@ -162,6 +481,22 @@ int get_priority(struct task_t *task, long t) {
 	return task->phase_2_prio;
 }
 
+/*
+ * Record the age (time since release) at time point t of the active jobs that
+ * are in phase 2, keeping the smallest such age seen in each task. Only used
+ * when pruning phase change points (see test_all_phase_change_points_pruned()).
+ */
+void record_phase_2_ages(struct taskset_t *ts, long t) {
+	for (int i = 0; i < NUM_TASKS; i++) {
+		struct task_t *task = &ts->tasks[i];
+		long age = t - task->last_release_time;
+		if (is_active(task) && age >= task->phase_change_point &&
+				age < task->min_phase_2_age) {
+			task->min_phase_2_age = age;
+		}
+	}
+}
+
 /*
  * Get a pointer to the highest-priority active task at time point t.
  * Returns NULL if there are no active tasks.
@@ -182,21 +517,223 @@ struct task_t *get_highest_prio_active_task(struct taskset_t *ts, long t) {
 	return hp_task;
 }
 
+#if INSTRUMENT
+/*
+ * Count a simulation of the task set that covered the time points from start
+ * up to (but not including) end, where miss_task missed its deadline (NULL if
+ * none did).
+ */
+void count_simulation(struct taskset_t *ts, struct task_t *miss_task,
+		long start, long end) {
+	struct counters_t *counters = &ts->counters;
+	counters->simulations++;
+	counters->ticks += end - start;
+	if (miss_task != NULL) {
+		int bucket = 0;
+		while (bucket < MISS_TIME_BUCKETS - 1 && (end >> bucket) > 0) {
+			bucket++;
+		}
+		counters->misses_by_task[miss_task - ts->tasks]++;
+		counters->misses_at_time[bucket]++;
+	}
+}
+
+#define COUNTERS_INITIALIZER , {0, 0, 0, {0}, {0}}
+#define COUNT_SIMULATION(ts, miss_task, start, end) \
+	count_simulation(ts, miss_task, start, end)
+#define COUNT_BATCHED_SIMULATIONS(ts, lanes) \
+	((ts)->counters.batched_simulations += (lanes))
+#else
+#define COUNTERS_INITIALIZER
+#define COUNT_SIMULATION(ts, miss_task, start, end) ((void)0)
+#define COUNT_BATCHED_SIMULATIONS(ts, lanes) ((void)0)
+#endif
+
+/*
+ * Schedule trace of simulate_sas() (see the trace command), which is only
+ * recorded while options.trace is set. The scheduling events are stored in a
+ * ring buffer of bytes as records of one varint each, holding the time since
+ * the previous record, the kind of event and the task. Most records take one
+ * byte. When the buffer is full, the oldest records are dropped, so that the
+ * events before the end of a simulation (e.g., a deadline miss) are kept.
+ */
+enum trace_event_t {
+	TRACE_RELEASE,    /* A job of the task is released */
+	TRACE_PROMOTION,  /* The active job of the task reaches phase 2 */
+	TRACE_DISPATCH,   /* The task starts to run */
+	TRACE_PREEMPTION, /* The running task is preempted by another one */
+	TRACE_COMPLETION, /* The active job of the task completes */
+	TRACE_IDLE,       /* The processor becomes idle (task is 0) */
+	TRACE_MISS,       /* The task misses its deadline */
+};
+
+#define TRACE_TASK_BITS  2 /* Enough for NUM_TASKS = 4 */
+#define TRACE_EVENT_BITS 3
+#define TRACE_MAX_RECORD 10 /* Bytes in the longest varint of 64 bits */
+
+struct trace_t {
+	uint8_t *buffer;  /* Ring buffer of records */
+	size_t capacity;  /* Bytes in the buffer */
+	size_t tail;      /* Position of the oldest record */
+	size_t used;      /* Bytes of records in the buffer */
+	long first_time;  /* Time that the delta of the oldest record is from */
+	long last_time;   /* Time of the newest record */
+	long records;     /* Records in the buffer */
+	long dropped;     /* Oldest records dropped when the buffer was full */
+	int running;      /* Index of the running task, or -1 if idle */
+	int miss_task;    /* Index of the task that missed, or -1 if none */
+	long end_time;    /* Time point at which the simulation ended */
+};
+
+struct trace_t trace = {NULL, 0, 0, 0, 0, 0, 0, 0, -1, -1, 0};
+
+/*
+ * Read the varint of the record at position pos of the ring buffer into
+ * *value.
+ *
+ * Returns the number of bytes of the record.
+ */
+size_t read_trace_record(const uint8_t *buffer, size_t capacity, size_t pos,
+		uint64_t *value) {
+	size_t length = 0;
+	int shift = 0;
+	uint8_t byte;
+	*value = 0;
+	do {
+		byte = buffer[(pos + length) % capacity];
+		*value |= (uint64_t)(byte & 0x7f) << shift;
+		shift += 7;
+		length++;
+	} while (byte & 0x80);
+	return length;
+}
+
+/*
+ * Empty the trace before a new simulation.
+ */
+void start_trace() {
+	trace.tail = 0;
+	trace.used = 0;
+	trace.first_time = 0;
+	trace.last_time = 0;
+	trace.records = 0;
+	trace.dropped = 0;
+	trace.running = -1;
+	trace.miss_task = -1;
+	trace.end_time = 0;
+}
+
+/*
+ * Record that the event happened to the task with index task at time point t,
+ * dropping the oldest records if the buffer is full.
+ */
+void trace_event(enum trace_event_t event, int task, long t) {
+	uint64_t value = (uint64_t)(t - trace.last_time) <<
+		(TRACE_EVENT_BITS + TRACE_TASK_BITS);
+	value |= (uint64_t)event << TRACE_TASK_BITS | task;
+	uint8_t record[TRACE_MAX_RECORD];
+	size_t length = 0;
+	do {
+		record[length] = (value & 0x7f) | (value > 0x7f ? 0x80 : 0);
+		value >>= 7;
+		length++;
+	} while (value > 0);
+
+	while (trace.capacity - trace.used < length) {
+		uint64_t oldest;
+		size_t oldest_length = read_trace_record(trace.buffer,
+				trace.capacity, trace.tail, &oldest);
+		trace.first_time += oldest >> (TRACE_EVENT_BITS + TRACE_TASK_BITS);
+		trace.tail = (trace.tail + oldest_length) % trace.capacity;
+		trace.used -= oldest_length;
+		trace.records--;
+		trace.dropped++;
+	}
+	for (size_t k = 0; k < length; k++) {
+		trace.buffer[(trace.tail + trace.used + k) % trace.capacity] =
+			record[k];
+	}
+	trace.used += length;
+	trace.records++;
+	trace.last_time = t;
+}
+
+/*
+ * Record the events of time point t of simulate_sas(), after the releases at
+ * t and before the highest-priority task hp_task (NULL if none) executes.
+ */
+void trace_tick(struct taskset_t *ts, struct task_t *hp_task, long t) {
+	for (int i = 0; i < NUM_TASKS; i++) {
+		struct task_t *task = &ts->tasks[i];
+		if (task->last_release_time == t) {
+			trace_event(TRACE_RELEASE, i, t);
+		}
+		if (is_active(task) &&
+				t - task->last_release_time == task->phase_change_point) {
+			trace_event(TRACE_PROMOTION, i, t);
+		}
+	}
+
+	int running = hp_task != NULL ? (int)(hp_task - ts->tasks) : -1;
+	if (running != trace.running) {
+		/* A job that is released at t replaces one that has completed. */
+		struct task_t *previous = trace.running >= 0 ?
+			&ts->tasks[trace.running] : NULL;
+		if (previous != NULL && is_active(previous) &&
+				previous->last_release_time != t) {
+			trace_event(TRACE_PREEMPTION, trace.running, t);
+		}
+		if (running >= 0) {
+			trace_event(TRACE_DISPATCH, running, t);
+		} else {
+			trace_event(TRACE_IDLE, 0, t);
+		}
+		trace.running = running;
+	}
+	if (hp_task != NULL && hp_task->remaining_wcet == 1) {
+		trace_event(TRACE_COMPLETION, running, t + 1);
+	}
+}
+
+/*
+ * Record the end of the simulation at time point t, where the task with index
+ * miss_task missed its deadline (-1 if none did).
+ */
+void end_trace(int miss_task, long t) {
+	if (miss_task >= 0) {
+		trace_event(TRACE_MISS, miss_task, t);
+	}
+	trace.miss_task = miss_task;
+	trace.end_time = t;
+}
+
 /*
  * Simulate the SAS up to the hyper-period or the first deadline miss. 
  * Returns a pointer to the first task to miss a deadline, or NULL if all
  * deadlines are met.
+ *
+ * A run without misses cannot stop earlier. The state at time t includes the
+ * release phase t mod P of every task. With synchronous releases, all phases
+ * are zero again only at multiples of the hyper-period. So neither an idle
+ * instant nor any other state recurs before the hyper-period.
  */
 struct task_t *simulate_sas(struct taskset_t *ts) {
 	reset_simulation_state(ts);
 	long t = 0;
 	struct task_t *hp_task;
+	if (options.trace) {
+		start_trace();
+	}
 
 	while (t <= ts->hyper_period) {
 
 		/* Check for deadline misses. */
 		for (int i = 0; i < NUM_TASKS; i++) {
 			if (has_missed_deadline(&ts->tasks[i], t)) {
+				COUNT_SIMULATION(ts, &ts->tasks[i], 0, t);
+				if (options.trace) {
+					end_trace(i, t);
+				}
 				return &ts->tasks[i]; /* Return on first deadline miss. */
 			}
 		}
@@ -208,339 +745,6166 @@ struct task_t *simulate_sas(struct taskset_t *ts) {
 			}
 		}
 
+		if (options.prune) {
+			record_phase_2_ages(ts, t);
+		}
+
 		/* Execute the highest-priority task and progress time. */
 		hp_task = get_highest_prio_active_task(ts, t);
+		if (options.trace) {
+			trace_tick(ts, hp_task, t);
+		}
 		if (hp_task != NULL) {
 			hp_task->remaining_wcet--;
 		}
 		t++;
 	}
 
+	COUNT_SIMULATION(ts, NULL, 0, t);
+	if (options.trace) {
+		end_trace(-1, t);
+	}
 	return NULL; /* No deadline misses in the SAS. */
 }
 
 /*
- * ============================================================================
- * Functions for exhaustively testing dual-priority schedulability.
+ * Get the earliest time point after t at which the scheduling decision of the
+ * SAS can change: a job release, a phase change of an active job, or the
+ * completion of the running job hp_task (which may be NULL). Returns at most
+ * end.
+ */
+long get_next_event_time(struct taskset_t *ts, struct task_t *hp_task, long t,
+		long end) {
+	long next = end;
+	long event;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		struct task_t *task = &ts->tasks[i];
+		event = task->last_release_time + task->period; /* Next release */
+		if (event < next) {
+			next = event;
+		}
+		event = task->last_release_time + task->phase_change_point;
+		if (is_active(task) && event > t && event < next) { /* Phase change */
+			next = event;
+		}
+	}
+	if (hp_task != NULL) {
+		event = t + hp_task->remaining_wcet; /* Completion */
+		if (event < next) {
+			next = event;
+		}
+	}
+	return next;
+}
+
+/*
+ * Simulate the SAS up to the hyper-period or the first deadline miss, with the
+ * same result as simulate_sas(). Instead of advancing time one unit at a time,
+ * the running job is executed up to the next time point at which the
+ * scheduling decision can change (see get_next_event_time()). Between two such
+ * time points the set of active jobs and their priorities stay the same, and
+ * deadline misses can only happen at job releases, so all the time points that
+ * are skipped would not have changed anything in simulate_sas().
  *
- * The below functionality is written in a naive style and is hard coded for
- * NUM_TASKS = 4 (which holds for all the counterexamples). For example, many
- * simple loops are unrolled, and combinations and permutations are generated
- * using nested for-loops instead of using more sophisticated methods.
+ * Returns a pointer to the first task to miss a deadline, or NULL if all
+ * deadlines are met.
+ */
+struct task_t *simulate_sas_event_driven(struct taskset_t *ts) {
+	reset_simulation_state(ts);
+	long t = 0;
+	long next_t;
+	struct task_t *hp_task;
+
+	while (t <= ts->hyper_period) {
+
+		/* Check for deadline misses. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			if (has_missed_deadline(&ts->tasks[i], t)) {
+				COUNT_SIMULATION(ts, &ts->tasks[i], 0, t);
+				return &ts->tasks[i]; /* Return on first deadline miss. */
+			}
+		}
+
+		/* Release new jobs from all ready tasks. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			if (can_release(&ts->tasks[i], t)) {
+				release(&ts->tasks[i], t);
+			}
+		}
+
+		/*
+		 * Jobs that are in phase 2 at t stay so until the next event, so
+		 * their smallest age in phase 2 up to the next event is seen at t.
+		 */
+		if (options.prune) {
+			record_phase_2_ages(ts, t);
+		}
+
+		/* Execute the highest-priority task up to the next event. */
+		hp_task = get_highest_prio_active_task(ts, t);
+		next_t = get_next_event_time(ts, hp_task, t, ts->hyper_period + 1);
+		if (hp_task != NULL) {
+			hp_task->remaining_wcet -= next_t - t;
+		}
+		t = next_t;
+	}
+
+	COUNT_SIMULATION(ts, NULL, 0, t);
+	return NULL; /* No deadline misses in the SAS. */
+}
+
+/*
+ * ============================================================================
+ * Table-driven simulation of the SAS.
  *
- * The intent with this naive coding is that it should be as easy as possible
- * for a (human) reader to verify the correctness of the code.
+ * With fixed priorities, the task chosen to run only depends on which tasks
+ * are active and in which phase each of them is. Each task is in one of
+ * three states (inactive, phase 1 or phase 2), so there are 3^NUM_TASKS
+ * states of the task set in total. The chosen task for every state is looked
+ * up in a table, which is built when the priorities change.
  * ============================================================================
  */
 
+#define DISPATCH_STATES (3*3*3*3) /* 3^NUM_TASKS */
+
 /*
- * Test whether the task set is dual-priority schedulable with the current 
- * priorities and phase change points set according to the FDMS policy.
- *
- * Returns 1 if the task set is schedulable using this policy, 0 otherwise.
- *
- * Precondition: The task set has four tasks, with phase 1 and phase 2
- *               priorities already set.
- *
- * The FDMS policy works as follows.
- *
- * (1) All the phase change points are set equal to the corresponding periods.
- * (2) The SAS is simulated for one hyper-period, or until a deadline miss.
- * (3) If there are no deadline misses in (2), the task set is schedulable.
- *     Otherwise, the phase change point of the first task to miss its deadline
- *     is decreased by 1. If the phase change point of that task was already 0,
- *     then the FDMS policy fails. Otherwise, repeat from (2).
+ * Table of the task to run in each state of the task set, for the priorities
+ * that it was built for. The state has digit s_i = 0 (task i inactive), 1
+ * (phase 1) or 2 (phase 2) in base 3, with task 0 as the lowest digit.
  */
-int test_fdms_phase_change_points(struct taskset_t *ts) {
-	ts->tasks[0].phase_change_point = ts->tasks[0].period;
-	ts->tasks[1].phase_change_point = ts->tasks[1].period;
-	ts->tasks[2].phase_change_point = ts->tasks[2].period;
-	ts->tasks[3].phase_change_point = ts->tasks[3].period;
+struct dispatch_table_t {
+	int built; /* Set to 1 when the entries below are valid */
+	int phase_1_prio[NUM_TASKS];
+	int phase_2_prio[NUM_TASKS];
+	signed char hp_task[DISPATCH_STATES]; /* Index of task to run, or -1 */
+};
 
-	struct task_t *miss_task;
-	while (1) {
-		miss_task = simulate_sas(ts);
-		if (miss_task == NULL) { /* No deadline miss, return success */
-			return 1;
-		} else if (miss_task->phase_change_point > 0) { /* Decrease point */
-			miss_task->phase_change_point--;
-		} else { /* Phase change point already zero, return failure */
-			return 0;
+pthread_key_t dispatch_table_key; /* Each thread has its own table */
+pthread_once_t dispatch_table_once = PTHREAD_ONCE_INIT;
+
+void create_dispatch_table_key() {
+	if (pthread_key_create(&dispatch_table_key, free) != 0) {
+		fprintf(stderr, "Could not create dispatch table key.\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * Build the dispatch table for the priorities of the task set. The task to
+ * run in each state is chosen exactly as by get_highest_prio_active_task().
+ */
+void build_dispatch_table(struct dispatch_table_t *table,
+		struct taskset_t *ts) {
+	for (int i = 0; i < NUM_TASKS; i++) {
+		table->phase_1_prio[i] = ts->tasks[i].phase_1_prio;
+		table->phase_2_prio[i] = ts->tasks[i].phase_2_prio;
+	}
+	for (int state = 0; state < DISPATCH_STATES; state++) {
+		int highest_prio = -1;
+		int hp_task = -1;
+		int digits = state;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			int task_state = digits % 3;
+			digits /= 3;
+			if (task_state != 0) { /* Task is active */
+				int prio = task_state == 1 ? table->phase_1_prio[i] :
+					table->phase_2_prio[i];
+				if (prio < highest_prio || highest_prio < 0) {
+					highest_prio = prio;
+					hp_task = i;
+				}
+			}
+		}
+		table->hp_task[state] = hp_task;
+	}
+	table->built = 1;
+}
+
+/*
+ * Get the dispatch table of the calling thread for the priorities of the task
+ * set, building it if it was last built for other priorities. Within one
+ * priority permutation, it is only built once.
+ */
+struct dispatch_table_t *get_dispatch_table(struct taskset_t *ts) {
+	pthread_once(&dispatch_table_once, create_dispatch_table_key);
+	struct dispatch_table_t *table = pthread_getspecific(dispatch_table_key);
+	if (table == NULL) {
+		table = xmalloc(sizeof(struct dispatch_table_t));
+		table->built = 0;
+		if (pthread_setspecific(dispatch_table_key, table) != 0) {
+			fprintf(stderr, "Could not set dispatch table.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	int stale = !table->built;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		stale |= table->phase_1_prio[i] != ts->tasks[i].phase_1_prio;
+		stale |= table->phase_2_prio[i] != ts->tasks[i].phase_2_prio;
+	}
+	if (stale) {
+		build_dispatch_table(table, ts);
+	}
+	return table;
+}
+
+/*
+ * Simulate the SAS up to the hyper-period or the first deadline miss, with the
+ * same result as simulate_sas(). Instead of comparing the priorities of the
+ * active tasks, the task to run is looked up in the dispatch table. The state
+ * index is kept up to date as jobs are released, change phase and complete,
+ * which are the only events that change it.
+ *
+ * Returns a pointer to the first task to miss a deadline, or NULL if all
+ * deadlines are met.
+ */
+struct task_t *simulate_sas_table(struct taskset_t *ts) {
+	const signed char *hp_task = get_dispatch_table(ts)->hp_task;
+	const int weight[NUM_TASKS] = {1, 3, 9, 27}; /* 3^i */
+	int task_state[NUM_TASKS]; /* Digit of each task in the state index */
+	int state = 0;
+	reset_simulation_state(ts);
+	long t = 0;
+
+	for (int i = 0; i < NUM_TASKS; i++) {
+		task_state[i] = 0; /* Inactive */
+	}
+
+	while (t <= ts->hyper_period) {
+
+		/*
+		 * Release new jobs from all ready tasks, and change phases. Deadline
+		 * misses only happen at releases, and releasing the jobs of earlier
+		 * tasks does not change whether a later task misses its deadline, so
+		 * the first task to miss is the same as in simulate_sas().
+		 */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			struct task_t *task = &ts->tasks[i];
+			if (can_release(task, t)) {
+				if (has_missed_deadline(task, t)) {
+					COUNT_SIMULATION(ts, task, 0, t);
+					return task; /* Return on first deadline miss. */
+				}
+				release(task, t);
+				state -= task_state[i] * weight[i];
+				task_state[i] = 1; /* Phase 1 */
+				state += weight[i];
+			}
+			if (task_state[i] == 1 &&
+					t - task->last_release_time == task->phase_change_point) {
+				task_state[i] = 2; /* Phase 2 */
+				state += weight[i];
+			}
+		}
+
+		if (options.prune) {
+			record_phase_2_ages(ts, t);
+		}
+
+		/* Look up the task to run and progress time. */
+		int i = hp_task[state];
+		if (i >= 0 && --ts->tasks[i].remaining_wcet == 0) {
+			state -= task_state[i] * weight[i];
+			task_state[i] = 0; /* Inactive */
+		}
+		t++;
+	}
+
+	COUNT_SIMULATION(ts, NULL, 0, t);
+	return NULL; /* No deadline misses in the SAS. */
+}
+
+/*
+ * ============================================================================
+ * Countdown simulation of the SAS.
+ *
+ * Instead of the release time of its last job, each task keeps the number of
+ * time units until its next release and until its active job is in phase 2,
+ * which are counted down at every time unit. Releases, deadline misses and
+ * phase changes are then tests for zero. With make SPECIALIZE=1, there is also
+ * a copy of the simulator for each of the three counterexamples, with the
+ * WCETs, periods and hyper-period of its task set as constants. The tick and
+ * countdown engines use it automatically for these task sets. The selfcheck
+ * command compares all of them with simulate_sas().
+ * ============================================================================
+ */
+
+#ifdef __GNUC__
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+#else
+#define ALWAYS_INLINE inline
+#endif
+
+/*
+ * Simulate the SAS like simulate_sas(), but with countdowns, and with the
+ * given WCETs, periods and hyper-period instead of those in the task set,
+ * which must be the same. Inlined into simulate_countdown() and into the
+ * specialized simulators, which call it with constants (see
+ * SPECIALIZED_SIMULATOR()).
+ *
+ * Returns a pointer to the first task to miss a deadline, or NULL if all
+ * deadlines are met.
+ */
+static ALWAYS_INLINE struct task_t *simulate_sas_countdown(
+		struct taskset_t *ts,
+		const int *wcet, const int *period, long hyper_period) {
+	int to_release[NUM_TASKS]; /* Time units until the next release */
+	int to_phase_2[NUM_TASKS]; /* Time units until the job is in phase 2 */
+	int remaining[NUM_TASKS];  /* Remaining WCET of the job */
+	int pcp[NUM_TASKS], phase_1_prio[NUM_TASKS], phase_2_prio[NUM_TASKS];
+
+	for (int i = 0; i < NUM_TASKS; i++) {
+		to_release[i] = 0; /* All tasks release a job at time 0 */
+		to_phase_2[i] = 0;
+		remaining[i] = 0;
+		pcp[i] = ts->tasks[i].phase_change_point;
+		phase_1_prio[i] = ts->tasks[i].phase_1_prio;
+		phase_2_prio[i] = ts->tasks[i].phase_2_prio;
+		ts->tasks[i].min_phase_2_age = LONG_MAX;
+	}
+
+	for (long t = 0; t <= hyper_period; t++) {
+
+		/* Check for deadline misses. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			if (to_release[i] == 0 && remaining[i] > 0) {
+				COUNT_SIMULATION(ts, &ts->tasks[i], 0, t);
+				return &ts->tasks[i]; /* Return on first deadline miss. */
+			}
+		}
+
+		/* Release new jobs from all ready tasks. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			if (to_release[i] == 0) {
+				to_release[i] = period[i];
+				to_phase_2[i] = pcp[i];
+				remaining[i] = wcet[i];
+			}
+		}
+
+		if (options.prune) { /* See record_phase_2_ages() */
+			for (int i = 0; i < NUM_TASKS; i++) {
+				long age = period[i] - to_release[i];
+				if (remaining[i] > 0 && to_phase_2[i] == 0 &&
+						age < ts->tasks[i].min_phase_2_age) {
+					ts->tasks[i].min_phase_2_age = age;
+				}
+			}
+		}
+
+		/* Execute the highest-priority task and progress time. */
+		int hp = -1;
+		int hp_prio = 0;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			int prio = to_phase_2[i] > 0 ? phase_1_prio[i] : phase_2_prio[i];
+			if (remaining[i] > 0 && (prio < hp_prio || hp < 0)) {
+				hp = i;
+				hp_prio = prio;
+			}
+		}
+		if (hp >= 0) {
+			remaining[hp]--;
+		}
+		for (int i = 0; i < NUM_TASKS; i++) {
+			to_release[i]--;
+			if (to_phase_2[i] > 0) {
+				to_phase_2[i]--;
+			}
+		}
+	}
+
+	COUNT_SIMULATION(ts, NULL, 0, hyper_period + 1);
+	return NULL; /* No deadline misses in the SAS. */
+}
+
+/*
+ * Simulate the SAS of any task set with simulate_sas_countdown().
+ *
+ * Returns a pointer to the first task to miss a deadline, or NULL if all
+ * deadlines are met.
+ */
+struct task_t *simulate_countdown(struct taskset_t *ts) {
+	int wcet[NUM_TASKS];
+	int period[NUM_TASKS];
+	for (int i = 0; i < NUM_TASKS; i++) {
+		wcet[i] = ts->tasks[i].wcet;
+		period[i] = ts->tasks[i].period;
+	}
+	return simulate_sas_countdown(ts, wcet, period, ts->hyper_period);
+}
+
+#if SPECIALIZE
+/*
+ * Define a simulator specialized for the task set with the given WCETs,
+ * periods and hyper-period.
+ */
+#define SPECIALIZED_SIMULATOR(name, W1, P1, W2, P2, W3, P3, W4, P4, H) \
+	struct task_t *name(struct taskset_t *ts) { \
+		const int wcet[NUM_TASKS] = {W1, W2, W3, W4}; \
+		const int period[NUM_TASKS] = {P1, P2, P3, P4}; \
+		return simulate_sas_countdown(ts, wcet, period, H); \
+	}
+
+SPECIALIZED_SIMULATOR(simulate_sas_counterexample_1,
+		8, 19, 13, 29, 9, 151, 14, 197, 16390597L)
+SPECIALIZED_SIMULATOR(simulate_sas_counterexample_2,
+		13, 29, 17, 47, 4, 89, 28, 193, 23412251L)
+SPECIALIZED_SIMULATOR(simulate_sas_counterexample_3,
+		6, 11, 6, 20, 4, 46, 5, 74, 187220L)
+
+/*
+ * A specialized simulator and the task set it is made for.
+ */
+struct specialized_simulator_t {
+	int wcet[NUM_TASKS];
+	int period[NUM_TASKS];
+	long hyper_period;
+	struct task_t *(*simulate)(struct taskset_t *ts);
+};
+
+const struct specialized_simulator_t specialized_simulators[] = {
+	{{8, 13, 9, 14}, {19, 29, 151, 197}, 16390597L,
+		simulate_sas_counterexample_1},
+	{{13, 17, 4, 28}, {29, 47, 89, 193}, 23412251L,
+		simulate_sas_counterexample_2},
+	{{6, 6, 4, 5}, {11, 20, 46, 74}, 187220L,
+		simulate_sas_counterexample_3},
+};
+
+#define NUM_SPECIALIZED_SIMULATORS \
+	(sizeof(specialized_simulators) / sizeof(specialized_simulators[0]))
+
+/*
+ * Get the specialized simulator made for the task set, or NULL if there is
+ * none.
+ */
+const struct specialized_simulator_t *find_specialized_simulator(
+		struct taskset_t *ts) {
+	for (size_t s = 0; s < NUM_SPECIALIZED_SIMULATORS; s++) {
+		const struct specialized_simulator_t *spec = &specialized_simulators[s];
+		int same = ts->hyper_period == spec->hyper_period;
+		for (int i = 0; i < NUM_TASKS && same; i++) {
+			same = ts->tasks[i].wcet == spec->wcet[i] &&
+				ts->tasks[i].period == spec->period[i];
+		}
+		if (same) {
+			return spec;
+		}
+	}
+	return NULL;
+}
+#endif
+
+/*
+ * ============================================================================
+ * Compact simulation of the SAS.
+ *
+ * The readable struct taskset_t is converted to a struct compact_taskset_t,
+ * and the simulation state of each task is kept in small local arrays of
+ * uint8_t (all four tasks' values of each array fit in one 32-bit register)
+ * instead of being reached through struct task_t pointers.
+ * ============================================================================
+ */
+
+/*
+ * Check if the task set can be simulated by simulate_sas_compact().
+ */
+int is_compactable(struct taskset_t *ts) {
+	for (int i = 0; i < NUM_TASKS; i++) {
+		if (ts->tasks[i].period > COMPACT_MAX_PERIOD) {
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/*
+ * Convert the task set, with its current priorities and phase change points,
+ * to the compact representation.
+ *
+ * Precondition: is_compactable(ts) is true.
+ */
+void compact_taskset(struct compact_taskset_t *cts, struct taskset_t *ts) {
+	for (int i = 0; i < NUM_TASKS; i++) {
+		cts->wcet[i] = ts->tasks[i].wcet;
+		cts->period[i] = ts->tasks[i].period;
+		cts->phase_1_prio[i] = ts->tasks[i].phase_1_prio;
+		cts->phase_2_prio[i] = ts->tasks[i].phase_2_prio;
+		cts->phase_change_point[i] = ts->tasks[i].phase_change_point;
+	}
+	cts->hyper_period = ts->hyper_period;
+}
+
+/*
+ * Simulate the SAS of the compact task set with the same result as
+ * simulate_sas(). Instead of the time of the last release, each task keeps
+ * the age of its job (time since release), which is below the period. The
+ * current priority of each task is only updated when its job is released or
+ * reaches its phase change point.
+ *
+ * If min_phase_2_age is not NULL, the smallest age of an active job in phase
+ * 2 is stored there for each task, as for record_phase_2_ages() (LONG_MAX if
+ * there is none).
+ *
+ * Returns the index of the first task to miss a deadline, or -1 if all
+ * deadlines are met.
+ */
+int simulate_sas_compact(struct compact_taskset_t *cts, long *min_phase_2_age) {
+	assert(NUM_TASKS <= 4);            /* Task index stored in 2 bits below */
+	uint8_t remaining_wcet[NUM_TASKS];
+	uint8_t age[NUM_TASKS];
+	uint8_t prio[NUM_TASKS];
+	uint8_t min_age[NUM_TASKS];
+	const uint8_t no_age = UINT8_MAX; /* Above all ages, as periods < 255 */
+
+	for (int i = 0; i < NUM_TASKS; i++) { /* Release all jobs at t = 0 */
+		remaining_wcet[i] = cts->wcet[i];
+		age[i] = 0;
+		prio[i] = cts->phase_change_point[i] == 0 ?
+			cts->phase_2_prio[i] : cts->phase_1_prio[i];
+		min_age[i] = no_age;
+	}
+
+	long t = 0;
+	int result = -1;
+	while (1) {
+
+		if (min_phase_2_age != NULL) {
+			for (int i = 0; i < NUM_TASKS; i++) {
+				if (remaining_wcet[i] > 0 &&
+						age[i] >= cts->phase_change_point[i] &&
+						age[i] < min_age[i]) {
+					min_age[i] = age[i];
+				}
+			}
+		}
+
+		/*
+		 * Execute the highest-priority task and progress time. The selection
+		 * is written without branches (as the outcome is unpredictable), using
+		 * a key of (priority, task index) that is no_age for inactive tasks.
+		 */
+		uint8_t hp_key = no_age;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			uint8_t key = remaining_wcet[i] > 0 ? (prio[i] << 2) | i : no_age;
+			hp_key = key < hp_key ? key : hp_key;
+		}
+		for (int i = 0; i < NUM_TASKS; i++) { /* Keeps arrays in registers */
+			remaining_wcet[i] -= hp_key == ((prio[i] << 2) | i);
+		}
+		t++;
+
+		if (t > cts->hyper_period) {
+			break; /* No deadline misses in the SAS. */
+		}
+
+		/*
+		 * Age all jobs. A job reaching its period has its deadline now and
+		 * is replaced by a new job. The first task to miss is the one with
+		 * the lowest index, as in simulate_sas().
+		 */
+		int missed = 0; /* Bit i is set if task i missed its deadline */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			age[i]++;
+			int released = age[i] == cts->period[i];
+			missed |= (released && remaining_wcet[i] > 0) << i;
+			age[i] = released ? 0 : age[i];
+			remaining_wcet[i] = released ? cts->wcet[i] : remaining_wcet[i];
+			prio[i] = released ? cts->phase_1_prio[i] : prio[i];
+			prio[i] = age[i] == cts->phase_change_point[i] ?
+				cts->phase_2_prio[i] : prio[i];
+		}
+		if (missed) {
+			result = 0;
+			while (!(missed & (1 << result))) {
+				result++;
+			}
+			break; /* Return on first deadline miss. */
+		}
+	}
+
+	if (min_phase_2_age != NULL) {
+		for (int i = 0; i < NUM_TASKS; i++) {
+			min_phase_2_age[i] = min_age[i] == no_age ? LONG_MAX : min_age[i];
+		}
+	}
+	cts->end_time = t;
+	return result;
+}
+
+/*
+ * ============================================================================
+ * Batched simulation of the SAS in SIMD lanes.
+ *
+ * Simulations that only differ in the phase change point of the last task
+ * have the same job releases, so the age of each job is the same in all of
+ * them. Only the remaining WCETs, and the priority of the last task, differ.
+ * simulate_sas_batch() runs BATCH_LANES such simulations in lockstep, with
+ * one uint8_t lane per simulation, using AVX2 if the compiler targets it
+ * (e.g., with -mavx2 or -march=native) and plain loops over the lanes
+ * otherwise.
+ * ============================================================================
+ */
+
+#define BATCH_LANES 32 /* One AVX2 register of uint8_t */
+
+/*
+ * Simulate the SAS of the compact task set for the first num_lanes of the
+ * phase change points of the last task in last_pcp, all other parameters being
+ * the same. The phase change point of the last task in cts is ignored. Each
+ * lane is simulated exactly as by simulate_sas_compact(), and is retired when
+ * it misses a deadline.
+ *
+ * Returns the first lane in which all deadlines are met, or -1 if there is no
+ * such lane.
+ */
+int simulate_sas_batch(struct compact_taskset_t *cts, const uint8_t *last_pcp,
+		int num_lanes) {
+	const int last = NUM_TASKS - 1;
+	uint8_t age[NUM_TASKS]; /* Job ages, the same in all lanes */
+	uint8_t key[NUM_TASKS]; /* (priority, index) keys of the first tasks */
+	const uint8_t last_key_1 = (cts->phase_1_prio[last] << 2) | last;
+	const uint8_t last_key_2 = (cts->phase_2_prio[last] << 2) | last;
+	const uint8_t no_key = UINT8_MAX;
+	long t = 0;
+
+	assert(NUM_TASKS <= 4 && num_lanes <= BATCH_LANES);
+	for (int i = 0; i < NUM_TASKS; i++) { /* Release all jobs at t = 0 */
+		age[i] = 0;
+		key[i] = ((cts->phase_change_point[i] == 0 ?
+			cts->phase_2_prio[i] : cts->phase_1_prio[i]) << 2) | i;
+	}
+
+#ifdef __AVX2__
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i remaining_wcet[NUM_TASKS];
+	__m256i pcp;
+	__m256i alive;
+	uint8_t lanes[BATCH_LANES];
+
+	for (int l = 0; l < BATCH_LANES; l++) {
+		lanes[l] = l < num_lanes ? last_pcp[l] : 0;
+	}
+	pcp = _mm256_loadu_si256((__m256i *)lanes);
+	for (int l = 0; l < BATCH_LANES; l++) {
+		lanes[l] = l < num_lanes ? UINT8_MAX : 0;
+	}
+	alive = _mm256_loadu_si256((__m256i *)lanes);
+	for (int i = 0; i < NUM_TASKS; i++) {
+		remaining_wcet[i] = _mm256_set1_epi8(cts->wcet[i]);
+	}
+
+	while (1) {
+
+		/* Select the highest-priority active task in each lane. */
+		__m256i inactive[NUM_TASKS];
+		__m256i task_key[NUM_TASKS];
+		__m256i phase_2 = _mm256_cmpeq_epi8( /* pcp <= age of last task */
+				_mm256_max_epu8(pcp, _mm256_set1_epi8(age[last])),
+				_mm256_set1_epi8(age[last]));
+		__m256i hp_key = _mm256_set1_epi8((char)no_key);
+		for (int i = 0; i < NUM_TASKS; i++) {
+			inactive[i] = _mm256_cmpeq_epi8(remaining_wcet[i], zero);
+			task_key[i] = i < last ? _mm256_set1_epi8(key[i]) :
+				_mm256_blendv_epi8(_mm256_set1_epi8(last_key_1),
+						_mm256_set1_epi8(last_key_2), phase_2);
+			task_key[i] = _mm256_or_si256(task_key[i], inactive[i]);
+			hp_key = _mm256_min_epu8(hp_key, task_key[i]);
+		}
+
+		/* Execute it (adding -1 where the keys match) and progress time. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			remaining_wcet[i] = _mm256_add_epi8(remaining_wcet[i],
+					_mm256_andnot_si256(inactive[i],
+						_mm256_cmpeq_epi8(hp_key, task_key[i])));
+		}
+		t++;
+
+		if (t > cts->hyper_period) {
+			break; /* No deadline misses in the lanes still alive. */
+		}
+
+		/* Age all jobs, and retire the lanes with deadline misses. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			age[i]++;
+			if (age[i] == cts->period[i]) {
+				alive = _mm256_and_si256(alive,
+						_mm256_cmpeq_epi8(remaining_wcet[i], zero));
+				if (_mm256_testz_si256(alive, alive)) {
+					return -1; /* All lanes missed a deadline. */
+				}
+				age[i] = 0;
+				remaining_wcet[i] = _mm256_set1_epi8(cts->wcet[i]);
+				key[i] = (cts->phase_1_prio[i] << 2) | i;
+			}
+			if (age[i] == cts->phase_change_point[i]) {
+				key[i] = (cts->phase_2_prio[i] << 2) | i;
+			}
+		}
+	}
+
+	int alive_mask = _mm256_movemask_epi8(alive);
+	for (int l = 0; l < num_lanes; l++) {
+		if (alive_mask & (1 << l)) {
+			return l;
+		}
+	}
+	return -1;
+#else
+	uint8_t remaining_wcet[NUM_TASKS][BATCH_LANES];
+	uint8_t alive[BATCH_LANES];
+	uint8_t pcp[BATCH_LANES];
+
+	for (int l = 0; l < BATCH_LANES; l++) {
+		pcp[l] = l < num_lanes ? last_pcp[l] : 0;
+		alive[l] = l < num_lanes;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			remaining_wcet[i][l] = cts->wcet[i];
+		}
+	}
+
+	while (1) {
+
+		/* Select and execute the highest-priority active task in each lane. */
+		for (int l = 0; l < BATCH_LANES; l++) {
+			uint8_t task_key[NUM_TASKS];
+			uint8_t hp_key = no_key;
+			for (int i = 0; i < NUM_TASKS; i++) {
+				task_key[i] = i < last ? key[i] :
+					age[last] < pcp[l] ? last_key_1 : last_key_2;
+				task_key[i] = remaining_wcet[i][l] > 0 ? task_key[i] : no_key;
+				hp_key = task_key[i] < hp_key ? task_key[i] : hp_key;
+			}
+			for (int i = 0; i < NUM_TASKS; i++) {
+				remaining_wcet[i][l] -= task_key[i] == hp_key &&
+					hp_key != no_key;
+			}
+		}
+		t++;
+
+		if (t > cts->hyper_period) {
+			break; /* No deadline misses in the lanes still alive. */
+		}
+
+		/* Age all jobs, and retire the lanes with deadline misses. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			age[i]++;
+			if (age[i] == cts->period[i]) {
+				int any_alive = 0;
+				for (int l = 0; l < BATCH_LANES; l++) {
+					alive[l] &= remaining_wcet[i][l] == 0;
+					any_alive |= alive[l];
+					remaining_wcet[i][l] = cts->wcet[i];
+				}
+				if (!any_alive) {
+					return -1; /* All lanes missed a deadline. */
+				}
+				age[i] = 0;
+				key[i] = (cts->phase_1_prio[i] << 2) | i;
+			}
+			if (age[i] == cts->phase_change_point[i]) {
+				key[i] = (cts->phase_2_prio[i] << 2) | i;
+			}
+		}
+	}
+
+	for (int l = 0; l < num_lanes; l++) {
+		if (alive[l]) {
+			return l;
+		}
+	}
+	return -1;
+#endif
+}
+
+/*
+ * Simulate the SAS of the task set with simulate_sas_compact(). Falls back to
+ * simulate_sas() if the periods are too large for the compact representation.
+ *
+ * Returns a pointer to the first task to miss a deadline, or NULL if all
+ * deadlines are met.
+ */
+struct task_t *simulate_compact(struct taskset_t *ts) {
+	if (!is_compactable(ts)) {
+		return simulate_sas(ts);
+	}
+
+	struct compact_taskset_t cts;
+	long min_phase_2_age[NUM_TASKS];
+	compact_taskset(&cts, ts);
+	int miss_task = simulate_sas_compact(&cts,
+			options.prune ? min_phase_2_age : NULL);
+	if (options.prune) {
+		for (int i = 0; i < NUM_TASKS; i++) {
+			ts->tasks[i].min_phase_2_age = min_phase_2_age[i];
+		}
+	}
+	COUNT_SIMULATION(ts, miss_task >= 0 ? &ts->tasks[miss_task] : NULL, 0,
+			cts.end_time);
+	return miss_task >= 0 ? &ts->tasks[miss_task] : NULL;
+}
+
+/*
+ * Simulate the SAS using the engine selected by options.engine. All engines
+ * give the same result as simulate_sas(). With SPECIALIZE, the tick and
+ * countdown engines use the simulator specialized for the task set if there
+ * is one. The SIMD engine only differs from the compact engine in
+ * test_all_phase_change_points_batched(), and the GPU engine from the tick
+ * engine in test_all_phase_change_points_gpu().
+ */
+struct task_t *simulate(struct taskset_t *ts) {
+	switch (options.engine) {
+		case ENGINE_EVENT:
+			return simulate_sas_event_driven(ts);
+		case ENGINE_TABLE:
+			return simulate_sas_table(ts);
+		case ENGINE_COMPACT:
+		case ENGINE_SIMD: /* Single simulations use the compact engine */
+			return simulate_compact(ts);
+		case ENGINE_COUNTDOWN:
+#if SPECIALIZE
+			if (find_specialized_simulator(ts) != NULL) {
+				return find_specialized_simulator(ts)->simulate(ts);
+			}
+#endif
+			return simulate_countdown(ts);
+		case ENGINE_GPU: /* Single simulations run on the CPU */
+		case ENGINE_TICK:
+		default:
+#if SPECIALIZE
+			if (find_specialized_simulator(ts) != NULL) {
+				return find_specialized_simulator(ts)->simulate(ts);
+			}
+#endif
+			return simulate_sas(ts);
+	}
+}
+
+/*
+ * ============================================================================
+ * Functions for resuming simulations of the SAS from saved states.
+ * ============================================================================
+ */
+
+/*
+ * Save the simulation state of the task set at time point t.
+ */
+void save_snapshot(struct snapshot_t *snapshot, struct taskset_t *ts, long t) {
+	snapshot->t = t;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		snapshot->last_release_time[i] = ts->tasks[i].last_release_time;
+		snapshot->remaining_wcet[i] = ts->tasks[i].remaining_wcet;
+		snapshot->min_phase_2_age[i] = ts->tasks[i].min_phase_2_age;
+		snapshot->phase_change_point[i] = ts->tasks[i].phase_change_point;
+	}
+}
+
+/*
+ * Restore the simulation state of the task set from the snapshot. Returns the
+ * time point of the snapshot.
+ */
+long restore_snapshot(struct taskset_t *ts, struct snapshot_t *snapshot) {
+	for (int i = 0; i < NUM_TASKS; i++) {
+		ts->tasks[i].last_release_time = snapshot->last_release_time[i];
+		ts->tasks[i].remaining_wcet = snapshot->remaining_wcet[i];
+		ts->tasks[i].min_phase_2_age = snapshot->min_phase_2_age[i];
+	}
+	return snapshot->t;
+}
+
+/*
+ * Record a snapshot of the task set at time point t for all ages that the
+ * active jobs reach for the first time before next_t, below the phase change
+ * points of their tasks. The ages reached for the first time by the jobs of a
+ * task always follow the ones already recorded, as a job is active at all ages
+ * from its release until it completes.
+ */
+void record_fdms_snapshots(struct fdms_snapshots_t *fdms,
+		struct taskset_t *ts, long t, long next_t) {
+	if (next_t <= fdms->next_time) {
+		return;
+	}
+	int saved = 0;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		struct task_t *task = &ts->tasks[i];
+		long last_age = t - task->last_release_time + (next_t - t) - 1;
+		if (last_age >= task->phase_change_point) {
+			last_age = task->phase_change_point - 1;
+		}
+		if (!is_active(task) || last_age < fdms->recorded[i]) {
+			continue;
+		}
+		assert(t - task->last_release_time <= fdms->recorded[i]);
+		if (!saved) {
+			save_snapshot(&fdms->snapshots[fdms->num_snapshots], ts, t);
+			fdms->num_snapshots++;
+			saved = 1;
+		}
+		while (fdms->recorded[i] <= last_age) {
+			fdms->first[i][fdms->recorded[i]] = fdms->num_snapshots - 1;
+			fdms->recorded[i]++;
+		}
+	}
+
+	/* The earliest time point at which each task can reach a new age. */
+	fdms->next_time = LONG_MAX;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		struct task_t *task = &ts->tasks[i];
+		if (fdms->recorded[i] < task->phase_change_point) {
+			long next_time = task->last_release_time + fdms->recorded[i] +
+				(is_active(task) ? 0 : task->period);
+			if (next_time < fdms->next_time) {
+				fdms->next_time = next_time;
+			}
+		}
+	}
+}
+
+/*
+ * Discard all snapshots after the one with index last, which are not valid
+ * after a change of the schedule at that snapshot's time point or later.
+ */
+void discard_fdms_snapshots(struct fdms_snapshots_t *fdms, long last) {
+	fdms->num_snapshots = last + 1;
+	fdms->next_time = 0;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		while (fdms->recorded[i] > 0 &&
+				fdms->first[i][fdms->recorded[i] - 1] > last) {
+			fdms->recorded[i]--;
+		}
+	}
+}
+
+/*
+ * Simulate the SAS up to the hyper-period or the first deadline miss, in the
+ * same way as simulate_sas() (or as simulate_sas_event_driven() if
+ * event_driven is true). If resume_from is not NULL, the simulation starts
+ * from that saved state instead of from time point 0. If save_to is not NULL,
+ * the state is saved there at the first time point at which task save_task
+ * has an active job in phase 2. If fdms is not NULL, snapshots for the
+ * incremental FDMS policy are recorded in it.
+ *
+ * Returns a pointer to the first task to miss a deadline, or NULL if all
+ * deadlines are met.
+ */
+struct task_t *simulate_sas_resumable(struct taskset_t *ts,
+		struct snapshot_t *resume_from, int save_task,
+		struct snapshot_t *save_to, int event_driven,
+		struct fdms_snapshots_t *fdms) {
+	struct task_t *save_task_ptr = &ts->tasks[save_task];
+	long t;
+	long next_t;
+	struct task_t *hp_task;
+
+	if (resume_from != NULL) {
+		t = restore_snapshot(ts, resume_from);
+	} else {
+		reset_simulation_state(ts);
+		t = 0;
+		for (int i = 0; i < NUM_TASKS; i++) { /* No misses possible at t = 0 */
+			release(&ts->tasks[i], t);
+		}
+	}
+
+	while (1) {
+
+		/* Save the state when the phase change of save_task matters. */
+		if (save_to != NULL && save_to->t < 0 && is_active(save_task_ptr) &&
+				t - save_task_ptr->last_release_time >=
+				save_task_ptr->phase_change_point) {
+			save_snapshot(save_to, ts, t);
+		}
+
+		if (options.prune) {
+			record_phase_2_ages(ts, t);
+		}
+
+		/* Execute the highest-priority task and progress time. */
+		hp_task = get_highest_prio_active_task(ts, t);
+		next_t = t + 1;
+		if (event_driven) {
+			next_t = get_next_event_time(ts, hp_task, t, ts->hyper_period + 1);
+		}
+		if (fdms != NULL) {
+			record_fdms_snapshots(fdms, ts, t, next_t);
+		}
+		if (hp_task != NULL) {
+			hp_task->remaining_wcet -= next_t - t;
+		}
+		t = next_t;
+
+		if (t > ts->hyper_period) {
+			COUNT_SIMULATION(ts, NULL,
+					resume_from != NULL ? resume_from->t : 0, t);
+			return NULL; /* No deadline misses in the SAS. */
+		}
+
+		/* Check for deadline misses. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			if (has_missed_deadline(&ts->tasks[i], t)) {
+				COUNT_SIMULATION(ts, &ts->tasks[i],
+						resume_from != NULL ? resume_from->t : 0, t);
+				return &ts->tasks[i]; /* Return on first deadline miss. */
+			}
+		}
+
+		/* Release new jobs from all ready tasks. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			if (can_release(&ts->tasks[i], t)) {
+				release(&ts->tasks[i], t);
+			}
+		}
+	}
+}
+
+/*
+ * Simulate the SAS with the current phase change points, like simulate().
+ * When using the -s option, the simulation is resumed from the schedule
+ * prefix saved in *prefix by the previous call, and a new prefix is saved.
+ *
+ * The prefix of the previous call is saved at the first time point at which
+ * the last task had an active job in phase 2. If only the phase change point
+ * of the last task has since been increased, no priority of an active job can
+ * have differed before that time point, so the schedule is identical up to
+ * there. Set prefix->t to -1 before the first call for new phase change points
+ * of the other tasks.
+ */
+struct task_t *simulate_reusing_prefix(struct taskset_t *ts,
+		struct snapshot_t *prefix) {
+	if (!options.snapshots) {
+		return simulate(ts);
+	}
+
+	const int last = NUM_TASKS - 1;
+	if (prefix->t >= 0) {
+		for (int i = 0; i < last; i++) {
+			assert(ts->tasks[i].phase_change_point ==
+					prefix->phase_change_point[i]);
+		}
+		assert(ts->tasks[last].phase_change_point >
+				prefix->phase_change_point[last]);
+	}
+
+	struct snapshot_t next_prefix;
+	next_prefix.t = -1;
+	struct task_t *miss_task = simulate_sas_resumable(ts,
+			prefix->t >= 0 ? prefix : NULL, last, &next_prefix,
+			options.engine == ENGINE_EVENT, NULL);
+	if (next_prefix.t >= 0) {
+		*prefix = next_prefix;
+	}
+	return miss_task;
+}
+
+/*
+ * ============================================================================
+ * Shared state for searching the priority permutations, possibly using
+ * several worker threads (see the -j option).
+ * ============================================================================
+ */
+
+/*
+ * State shared by all workers in a search over priority permutations.
+ * All fields after the lock may only be accessed while holding it.
+ */
+struct search_t {
+	struct taskset_t *ts;            /* Task set to test, never modified */
+	struct prio_permutation_t *perms; /* All permutations to test */
+	long total_permutations;
+	pthread_mutex_t lock;
+	long next_permutation; /* Index of the next permutation to hand out */
+	int schedulable;       /* Set to 1 when a schedulable one is found */
+	long simulated_combinations; /* Statistics for the -p and -b options */
+	long skipped_combinations;
+	long bisection_fallbacks;
+	struct prefilter_stats_t prefilter_stats; /* Statistics for -f */
+	struct cursor_t cursors[MAX_THREADS]; /* Current chunk of each worker */
+	struct cursor_t resumed[MAX_THREADS]; /* Unfinished ones from checkpoint */
+	int *pending_chunks; /* Unfinished chunks of each permutation */
+	int num_resumed;
+	time_t next_checkpoint_time;
+	struct taskset_t witness; /* Schedulable configuration, if one was found */
+	long finished_permutations; /* Statistics for progress summaries */
+	time_t start_time;
+	time_t next_progress_time;
+	FILE *json;               /* JSON lines result stream, or NULL */
+#if INSTRUMENT
+	struct counters_t counters; /* Sum over all finished permutations */
+#endif
+};
+
+struct search_t search = {
+	NULL, NULL, 0, PTHREAD_MUTEX_INITIALIZER, 0, 0, 0, 0, 0,
+	{{0}, {0}, 0, 0, 0},
+	{{0, {0}, 0}}, {{0, {0}, 0}}, NULL, 0, 0, {{{0}}, 0 COUNTERS_INITIALIZER},
+	0, 0, 0, NULL COUNTERS_INITIALIZER
+};
+
+/*
+ * Serializes printing, so that output from different workers does not mix.
+ */
+pthread_mutex_t output_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void lock_output() {
+	pthread_mutex_lock(&output_lock);
+}
+
+void unlock_output() {
+	pthread_mutex_unlock(&output_lock);
+}
+
+/*
+ * Write a checkpoint of the search to options.checkpoint_file, from which the
+ * search can be resumed with read_checkpoint(). The file is first written
+ * under a temporary name and then renamed, so that it is replaced atomically.
+ * Failures are reported, but do not stop the search.
+ *
+ * Precondition: search.lock is held.
+ */
+void write_checkpoint() {
+	char temp_file[4096];
+	snprintf(temp_file, sizeof(temp_file), "%s.tmp", options.checkpoint_file);
+	FILE *f = fopen(temp_file, "w");
+	if (f == NULL) {
+		perror("Could not write checkpoint");
+		return;
+	}
+
+	fprintf(f, "dualpriotest checkpoint\n");
+	fprintf(f, "tasks");
+	for (int i = 0; i < NUM_TASKS; i++) {
+		fprintf(f, " %d %d", search.ts->tasks[i].wcet,
+				search.ts->tasks[i].period);
+	}
+	fprintf(f, "\npermutations %ld\n", search.total_permutations);
+	fprintf(f, "unique %d\n", options.unique);
+	fprintf(f, "shard %d %d\n", options.shard, options.num_shards);
+	fprintf(f, "order %d bisect %d prune %d snapshots %d\n", options.order,
+			options.bisect, options.prune, options.snapshots);
+	fprintf(f, "next %ld\n", search.next_permutation);
+	for (int w = 0; w < search.num_resumed + options.num_threads; w++) {
+		/* Resumed permutations not yet handed out, then all workers. */
+		struct cursor_t *cursor = w < search.num_resumed ?
+			&search.resumed[w] : &search.cursors[w - search.num_resumed];
+		if (cursor->permutation >= 0) {
+			fprintf(f, "cursor %ld", cursor->permutation);
+			for (int i = 0; i < NUM_TASKS; i++) {
+				fprintf(f, " %d", cursor->phase_change_point[i]);
+			}
+			fprintf(f, " %d\n", cursor->end);
+		}
+	}
+	fprintf(f, "end\n");
+
+	if (fflush(f) != 0 || fsync(fileno(f)) != 0 || fclose(f) != 0 ||
+			rename(temp_file, options.checkpoint_file) != 0) {
+		perror("Could not write checkpoint");
+	}
+}
+
+/*
+ * Read the checkpoint in options.resume_file into the search, which must
+ * already be set up with the same task set and permutations. The unfinished
+ * permutations of the checkpoint will be handed out first. Exits the program
+ * if the checkpoint is malformed or belongs to another search.
+ */
+void read_checkpoint() {
+	FILE *f = fopen(options.resume_file, "r");
+	if (f == NULL) {
+		perror("Could not read checkpoint");
+		exit(EXIT_FAILURE);
+	}
+
+	/* Set by %n only if the whole header matches. */
+	int header_length = 0;
+	int ok = fscanf(f, "dualpriotest checkpoint tasks%n",
+			&header_length) == 0 && header_length > 0;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		int wcet, period;
+		ok = ok && fscanf(f, "%d %d", &wcet, &period) == 2 &&
+			wcet == search.ts->tasks[i].wcet &&
+			period == search.ts->tasks[i].period;
+	}
+	long total_permutations;
+	int unique, shard, num_shards, order, bisect, prune, snapshots;
+	ok = ok && fscanf(f, " permutations %ld unique %d shard %d %d order %d "
+			"bisect %d prune %d snapshots %d next %ld",
+			&total_permutations, &unique, &shard, &num_shards, &order,
+			&bisect, &prune, &snapshots, &search.next_permutation) == 9 &&
+		total_permutations == search.total_permutations &&
+		unique == options.unique &&
+		shard == options.shard &&
+		num_shards == options.num_shards &&
+		order == (int)options.order && /* Cursors are positions in it */
+		bisect == options.bisect &&
+		prune == options.prune &&
+		snapshots == options.snapshots &&
+		search.next_permutation >= 0 &&
+		search.next_permutation <= search.total_permutations;
+
+	search.num_resumed = 0;
+	struct cursor_t cursor;
+	while (ok && search.num_resumed < MAX_THREADS &&
+			fscanf(f, " cursor %ld", &cursor.permutation) == 1) {
+		ok = cursor.permutation >= 0 &&
+			cursor.permutation < search.next_permutation;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			ok = ok && fscanf(f, "%d", &cursor.phase_change_point[i]) == 1 &&
+				cursor.phase_change_point[i] >= 0 &&
+				cursor.phase_change_point[i] <= search.ts->tasks[i].period;
+		}
+		ok = ok && cursor.phase_change_point[NUM_TASKS - 1] == 0 &&
+			fscanf(f, "%d", &cursor.end) == 1 &&
+			cursor.end > cursor.phase_change_point[0] &&
+			cursor.end <= search.ts->tasks[0].period + 1;
+		if (ok) {
+			search.pending_chunks[cursor.permutation]++;
+		}
+		search.resumed[search.num_resumed] = cursor;
+		search.num_resumed++;
+	}
+	char end[4];
+	ok = ok && fscanf(f, " %3s", end) == 1 && strcmp(end, "end") == 0;
+	fclose(f);
+
+	if (!ok) {
+		fprintf(stderr, "Checkpoint %s is malformed or belongs to another "
+				"search.\n", options.resume_file);
+		exit(EXIT_FAILURE);
+	}
+	printf("Resuming from checkpoint: %d unfinished chunks, then from "
+			"permutation %ld of %ld.\n\n",
+			search.num_resumed,
+			search.next_permutation + 1,
+			search.total_permutations);
+}
+
+/*
+ * Check if some worker has already found a schedulable configuration, in
+ * which case all other workers should stop searching.
+ *
+ * Also records that the worker with the given cursor has tested all
+ * combinations of phase change points before position[0..2] of T1..T3 in the
+ * order of the search (with T4's at 0), and writes a checkpoint or prints a
+ * progress summary if one is due.
+ */
+int search_is_stopped_at(struct cursor_t *cursor, const int *position) {
+	pthread_mutex_lock(&search.lock);
+	for (int i = 0; i < NUM_TASKS - 1; i++) {
+		cursor->phase_change_point[i] = position[i];
+	}
+	cursor->phase_change_point[NUM_TASKS - 1] = 0;
+	if (options.checkpoint_file != NULL &&
+			time(NULL) >= search.next_checkpoint_time) {
+		write_checkpoint();
+		search.next_checkpoint_time = time(NULL) + options.checkpoint_interval;
+	}
+	if (options.output == OUTPUT_PROGRESS &&
+			time(NULL) >= search.next_progress_time) {
+		printf("Progress: %ld of %ld priority permutations finished after "
+				"%lds.\n",
+				search.finished_permutations,
+				search.total_permutations,
+				(long)(time(NULL) - search.start_time));
+		search.next_progress_time = time(NULL) + options.progress_interval;
+	}
+	int stopped = search.schedulable;
+	pthread_mutex_unlock(&search.lock);
+	return stopped;
+}
+
+/*
+ * Same as search_is_stopped_at(), at the current phase change points of
+ * T1..T3 in the task set, for the searches that test them in increasing order.
+ */
+int search_is_stopped(struct cursor_t *cursor, struct taskset_t *ts) {
+	int position[NUM_TASKS];
+	for (int i = 0; i < NUM_TASKS; i++) {
+		position[i] = ts->tasks[i].phase_change_point;
+	}
+	return search_is_stopped_at(cursor, position);
+}
+
+/*
+ * Move the worker with the given cursor on to phase change point pcp of T1,
+ * with those of T2 and T3 at 0, unless it is not in the worker's chunk (see
+ * the -w option). Other workers may only take over the phase change points of
+ * T1 after the current one, so they never test the same combinations.
+ *
+ * Returns the phase change point of T1 to continue with, or the end of the
+ * chunk, which is stored in *end, if pcp is not in it. The chunk is then
+ * finished, and nothing of it is left to take over or to checkpoint.
+ */
+int advance_chunk(struct cursor_t *cursor, int pcp, int *end) {
+	pthread_mutex_lock(&search.lock);
+	*end = cursor->end;
+	if (pcp >= cursor->end) {
+		pcp = cursor->end;
+		cursor->permutation = -1;
+	} else if (pcp != cursor->phase_change_point[0]) {
+		for (int i = 0; i < NUM_TASKS; i++) {
+			cursor->phase_change_point[i] = 0;
+		}
+		cursor->phase_change_point[0] = pcp;
+	}
+	pthread_mutex_unlock(&search.lock);
+	return pcp;
+}
+
+/*
+ * Print a schedulable configuration of the task set found by a search.
+ */
+void print_witness(struct taskset_t *ts) {
+	if (options.output >= OUTPUT_PROGRESS) {
+		lock_output();
+		printf("Schedulable with this configuration:\n\n");
+		print_taskset(ts, 1, 1);
+		unlock_output();
+	}
+}
+
+/*
+ * Get the number of combinations of phase change points that come before the
+ * cursor in the order of the nested loops in test_all_phase_change_points().
+ */
+long combinations_before(struct taskset_t *ts, struct cursor_t *cursor) {
+	long before = 0;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		before = before * (ts->tasks[i].period + 1) +
+			cursor->phase_change_point[i];
+	}
+	return before;
+}
+
+/*
+ * Get the number of combinations of phase change points that come before the
+ * end of a chunk ending at phase change point end of T1.
+ */
+long combinations_before_chunk_end(struct taskset_t *ts, int end) {
+	struct cursor_t chunk_end = {0, {end, 0, 0, 0}, end};
+	return combinations_before(ts, &chunk_end);
+}
+
+/*
+ * ============================================================================
+ * Status reports of the searches over priority permutations (--status and
+ * --metrics options).
+ *
+ * While a search runs, a reporter thread samples its progress under the lock
+ * of the search every --progress-interval seconds. It writes a status line
+ * with the throughput and the estimated time to the end (ETA) to standard
+ * error or a file, and the same numbers as Prometheus metrics in the text
+ * format to another file. Both files are replaced atomically, so that a job
+ * scheduler can poll them. The workers count nothing extra for this. The
+ * covered combinations of phase change points are those of the finished
+ * permutations, plus the ones before the cursor of each worker in its current
+ * permutation. The workers update their cursors anyway. A chunk taken over
+ * from another worker (-w option) counts as if all combinations before it
+ * were covered, until its permutation is finished.
+ * ============================================================================
+ */
+
+/*
+ * Progress of the search at some point in time.
+ */
+struct status_sample_t {
+	double seconds;             /* Since the reporter started */
+	long finished_permutations;
+	long combinations;          /* Combinations covered so far */
+	long ticks;                 /* Of the finished permutations (INSTRUMENT) */
+};
+
+struct reporter_t {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t wakeup;   /* Signalled to stop the reporter */
+	int stop;
+	double start_time;       /* get_seconds() when the reporter started */
+	struct status_sample_t first;    /* When the reporter started */
+	struct status_sample_t previous; /* At the previous report */
+};
+
+struct reporter_t reporter = {
+	0, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER, 0, 0,
+	{0, 0, 0, 0}, {0, 0, 0, 0}
+};
+
+/*
+ * Take a sample of the progress of the search.
+ */
+void sample_status(struct status_sample_t *sample) {
+	long per_permutation = count_combinations(search.ts);
+	pthread_mutex_lock(&search.lock);
+	sample->seconds = get_seconds() - reporter.start_time;
+	sample->finished_permutations = search.finished_permutations;
+	sample->combinations = saturating_mul(search.finished_permutations,
+			per_permutation);
+	for (int w = 0; w < options.num_threads; w++) {
+		if (search.cursors[w].permutation >= 0) {
+			sample->combinations += combinations_before(search.ts,
+					&search.cursors[w]);
+		}
+	}
+#if INSTRUMENT
+	sample->ticks = search.counters.ticks;
+#else
+	sample->ticks = 0;
+#endif
+	pthread_mutex_unlock(&search.lock);
+}
+
+/*
+ * Format a number of seconds as hours, minutes and seconds.
+ */
+void format_duration(char *buffer, size_t size, double seconds) {
+	long s = (long)seconds;
+	snprintf(buffer, size, "%ldh%02ldm%02lds", s / 3600, s / 60 % 60, s % 60);
+}
+
+/*
+ * Open a temporary file next to path for replacing it by finish_status_file().
+ * Failures are reported, but do not stop the search.
+ *
+ * Returns the file, or NULL if it could not be opened.
+ */
+FILE *open_status_file(const char *path, char *temp_file, size_t size) {
+	snprintf(temp_file, size, "%s.tmp", path);
+	FILE *f = fopen(temp_file, "w");
+	if (f == NULL) {
+		perror("Could not write status");
+	}
+	return f;
+}
+
+/*
+ * Close the temporary file written for path and rename it to path.
+ */
+void finish_status_file(FILE *f, const char *path, const char *temp_file) {
+	if (fclose(f) != 0 || rename(temp_file, path) != 0) {
+		perror("Could not write status");
+	}
+}
+
+/*
+ * Write a status report of the sample, and of the throughput since the
+ * previous one, to options.status_file and options.metrics_file. Done is set
+ * for the last report, when the search has ended.
+ */
+void write_status(struct status_sample_t *sample, int done) {
+	struct status_sample_t *previous = &reporter.previous;
+	long total = saturating_mul(search.total_permutations,
+			count_combinations(search.ts));
+	double seconds = sample->seconds - reporter.first.seconds;
+	double interval = sample->seconds - previous->seconds;
+	double rate = seconds > 0 ?
+		(sample->combinations - reporter.first.combinations) / seconds : 0;
+	double current_rate = interval > 0 ?
+		(sample->combinations - previous->combinations) / interval : 0;
+#if INSTRUMENT
+	double tick_rate = interval > 0 ?
+		(sample->ticks - previous->ticks) / interval : 0;
+#endif
+	double eta = rate > 0 ? (total - sample->combinations) / rate : -1;
+	char temp_file[4096];
+
+	if (options.status_file != NULL) {
+		FILE *f = stderr;
+		if (strcmp(options.status_file, "-") != 0) {
+			f = open_status_file(options.status_file, temp_file,
+					sizeof(temp_file));
+		}
+		if (f != NULL) {
+			char elapsed[32], remaining[32];
+			format_duration(elapsed, sizeof(elapsed), sample->seconds);
+			format_duration(remaining, sizeof(remaining), eta);
+			fprintf(f, "Status after %s: %ld of %ld permutations, %.4g of "
+					"%.4g combinations (%.2f%%), %.4g/s (%.4g/s on average)",
+					elapsed, sample->finished_permutations,
+					search.total_permutations, (double)sample->combinations,
+					(double)total, 100.0 * sample->combinations / total,
+					current_rate, rate);
+#if INSTRUMENT
+			fprintf(f, ", %.4g ticks/s", tick_rate);
+#endif
+			if (done) {
+				fprintf(f, ", done.\n");
+			} else if (eta >= 0) {
+				fprintf(f, ", ETA %s.\n", remaining);
+			} else {
+				fprintf(f, ", no ETA yet.\n");
+			}
+			if (f != stderr) {
+				finish_status_file(f, options.status_file, temp_file);
+			}
+		}
+	}
+
+	if (options.metrics_file != NULL) {
+		FILE *f = open_status_file(options.metrics_file, temp_file,
+				sizeof(temp_file));
+		if (f != NULL) {
+			fprintf(f, "# HELP dualpriotest_permutations Priority "
+					"permutations to test.\n"
+					"# TYPE dualpriotest_permutations gauge\n"
+					"dualpriotest_permutations %ld\n"
+					"# HELP dualpriotest_permutations_finished Priority "
+					"permutations tested.\n"
+					"# TYPE dualpriotest_permutations_finished counter\n"
+					"dualpriotest_permutations_finished %ld\n",
+					search.total_permutations, sample->finished_permutations);
+			fprintf(f, "# HELP dualpriotest_combinations Combinations of "
+					"phase change points to test.\n"
+					"# TYPE dualpriotest_combinations gauge\n"
+					"dualpriotest_combinations %ld\n"
+					"# HELP dualpriotest_combinations_covered Combinations "
+					"of phase change points tested or skipped.\n"
+					"# TYPE dualpriotest_combinations_covered counter\n"
+					"dualpriotest_combinations_covered %ld\n"
+					"# HELP dualpriotest_combinations_per_second Covered in "
+					"the last interval.\n"
+					"# TYPE dualpriotest_combinations_per_second gauge\n"
+					"dualpriotest_combinations_per_second %.6g\n",
+					total, sample->combinations, current_rate);
+#if INSTRUMENT
+			fprintf(f, "# HELP dualpriotest_ticks Time points simulated in "
+					"finished permutations.\n"
+					"# TYPE dualpriotest_ticks counter\n"
+					"dualpriotest_ticks %ld\n"
+					"# HELP dualpriotest_ticks_per_second Simulated in the "
+					"last interval.\n"
+					"# TYPE dualpriotest_ticks_per_second gauge\n"
+					"dualpriotest_ticks_per_second %.6g\n",
+					sample->ticks, tick_rate);
+#endif
+			fprintf(f, "# HELP dualpriotest_elapsed_seconds Time since the "
+					"search started.\n"
+					"# TYPE dualpriotest_elapsed_seconds gauge\n"
+					"dualpriotest_elapsed_seconds %.1f\n"
+					"# HELP dualpriotest_eta_seconds Estimated time to the "
+					"end, -1 if unknown.\n"
+					"# TYPE dualpriotest_eta_seconds gauge\n"
+					"dualpriotest_eta_seconds %.0f\n"
+					"# HELP dualpriotest_done 1 when the search has ended.\n"
+					"# TYPE dualpriotest_done gauge\n"
+					"dualpriotest_done %d\n",
+					sample->seconds, done ? 0 : eta, done);
+			finish_status_file(f, options.metrics_file, temp_file);
+		}
+	}
+	*previous = *sample;
+}
+
+/*
+ * Write a status report every options.progress_interval seconds until
+ * stop_reporter() is called, and a last one after that.
+ */
+void *reporter_thread(void *arg) {
+	(void)arg;
+	struct status_sample_t sample;
+	pthread_mutex_lock(&reporter.lock);
+	while (!reporter.stop) {
+		struct timespec deadline;
+		clock_gettime(CLOCK_REALTIME, &deadline);
+		deadline.tv_sec += options.progress_interval;
+		int timed_out = 0;
+		while (!reporter.stop && !timed_out) {
+			timed_out = pthread_cond_timedwait(&reporter.wakeup,
+					&reporter.lock, &deadline) != 0;
+		}
+		if (!reporter.stop) {
+			pthread_mutex_unlock(&reporter.lock);
+			sample_status(&sample);
+			write_status(&sample, 0);
+			pthread_mutex_lock(&reporter.lock);
+		}
+	}
+	pthread_mutex_unlock(&reporter.lock);
+	return NULL;
+}
+
+/*
+ * Start the reporter thread for the search if a status or metrics file is
+ * set. The search must be set up, including any resumed checkpoint.
+ */
+void start_reporter() {
+	if (options.status_file == NULL && options.metrics_file == NULL) {
+		return;
+	}
+	reporter.stop = 0;
+	reporter.start_time = get_seconds();
+	sample_status(&reporter.first);
+	reporter.previous = reporter.first;
+	if (pthread_create(&reporter.thread, NULL, reporter_thread, NULL)) {
+		fprintf(stderr, "Could not create reporter thread.\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * Stop the reporter thread, if any, and write the last status report.
+ */
+void stop_reporter() {
+	if (options.status_file == NULL && options.metrics_file == NULL) {
+		return;
+	}
+	pthread_mutex_lock(&reporter.lock);
+	reporter.stop = 1;
+	pthread_cond_signal(&reporter.wakeup);
+	pthread_mutex_unlock(&reporter.lock);
+	pthread_join(reporter.thread, NULL);
+
+	struct status_sample_t sample;
+	sample_status(&sample);
+	write_status(&sample, 1);
+}
+
+/*
+ * ============================================================================
+ * Prefilters that reject combinations of phase change points without
+ * simulating the SAS (see the -f option).
+ *
+ * Each prefilter is a cheap necessary condition for schedulability. A
+ * combination that a prefilter rejects provably misses a deadline in the SAS,
+ * so it does not need to be simulated. All prefilters look at the first job of
+ * each task, which is released at time 0 together with the first jobs of all
+ * other tasks.
+ * ============================================================================
+ */
+
+/*
+ * Get the highest priority (smallest value) and the lowest priority (largest
+ * value) that any job of the task can have.
+ */
+void get_priority_range(struct task_t *task, int *highest, int *lowest) {
+	if (task->phase_change_point == 0) { /* Always in phase 2 */
+		*highest = *lowest = task->phase_2_prio;
+	} else if (task->phase_change_point >= task->period) { /* Never phase 2 */
+		*highest = *lowest = task->phase_1_prio;
+	} else {
+		*highest = task->phase_1_prio < task->phase_2_prio ?
+			task->phase_1_prio : task->phase_2_prio;
+		*lowest = task->phase_1_prio > task->phase_2_prio ?
+			task->phase_1_prio : task->phase_2_prio;
+	}
+}
+
+/*
+ * Get the smallest time point f >= start with
+ *
+ *    f = start + work + sum of W_j * (releases of T_j in [start, f))
+ *
+ * over the tasks j with higher[j] set, or a time point above limit if f is
+ * above limit. If the tasks j have higher priority than task i throughout
+ * [start, f), and task i has work units left to execute at start, then i
+ * cannot complete before f: every job of such a task j released in
+ * [start, f) must complete before i finishes, or i could not run at f - 1.
+ */
+long get_response_time(struct taskset_t *ts, const int *higher, long start,
+		long work, long limit) {
+	long f = start + work;
+	long next_f;
+	while (f <= limit) {
+		next_f = start + work;
+		for (int j = 0; j < NUM_TASKS; j++) {
+			long period = ts->tasks[j].period;
+			if (higher[j]) { /* Releases at multiples of the period */
+				next_f += ((f + period - 1) / period -
+						(start + period - 1) / period) * ts->tasks[j].wcet;
+			}
+		}
+		if (next_f == f) {
+			break;
+		}
+		f = next_f;
+	}
+	return f;
+}
+
+/*
+ * Each prefilter gets the task set, and the highest and lowest priority of
+ * each task as given by get_priority_range(). It returns 1 if the current
+ * combination of phase change points provably misses a deadline.
+ *
+ * Prefilter 1: reject if the response time of the first job of some task i,
+ * next to the jobs of a single task j that always has higher priority, is
+ * above its period. Only the jobs of j released before the job of i completes
+ * count, so it is not enough that j releases a job before the period of i.
+ */
+int prefilter_pair(struct taskset_t *ts, const int *highest,
+		const int *lowest) {
+	int higher[NUM_TASKS] = {0};
+	for (int i = 0; i < NUM_TASKS; i++) {
+		for (int j = 0; j < NUM_TASKS; j++) {
+			if (j == i || lowest[j] >= highest[i]) {
+				continue;
+			}
+			higher[j] = 1;
+			long response_time = get_response_time(ts, higher, 0,
+					ts->tasks[i].wcet, ts->tasks[i].period);
+			higher[j] = 0;
+			if (response_time > ts->tasks[i].period) {
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
+/*
+ * Prefilter 2: reject if the response time of the first job of some task i,
+ * next to the jobs of all tasks that always have higher priority, is above its
+ * period.
+ */
+int prefilter_rta(struct taskset_t *ts, const int *highest,
+		const int *lowest) {
+	int higher[NUM_TASKS];
+	for (int i = 0; i < NUM_TASKS; i++) {
+		for (int j = 0; j < NUM_TASKS; j++) {
+			higher[j] = j != i && lowest[j] < highest[i];
+		}
+		if (get_response_time(ts, higher, 0, ts->tasks[i].wcet,
+					ts->tasks[i].period) > ts->tasks[i].period) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Prefilter 3: as prefilter 2, but only for the part of the first job of task
+ * i after its phase change point. The job can execute at most as many units
+ * as its phase change point before it, and after it, the job has its phase 2
+ * priority, so more tasks may always have higher priority.
+ */
+int prefilter_phase_2(struct taskset_t *ts, const int *highest,
+		const int *lowest) {
+	int higher[NUM_TASKS];
+	(void)highest;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		struct task_t *task = &ts->tasks[i];
+		if (task->phase_change_point >= task->wcet) {
+			continue; /* The job may complete in phase 1 */
+		}
+		for (int j = 0; j < NUM_TASKS; j++) {
+			higher[j] = j != i && lowest[j] < task->phase_2_prio;
+		}
+		if (get_response_time(ts, higher, task->phase_change_point,
+					task->wcet - task->phase_change_point,
+					task->period) > task->period) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Cache of the verdicts of prefilter 4 (see prefilter_memo()). Each entry
+ * holds the key of a subset of the tasks with its priorities and phase change
+ * points, and whether the subset misses a deadline on its own. An entry whose
+ * slot is needed for another key is replaced, so the cache never grows. Each
+ * thread has its own cache, which is cleared when the task set changes.
+ */
+#define MEMO_CACHE_BITS 16   /* The cache has 2^MEMO_CACHE_BITS entries */
+#define MEMO_MAX_PERIOD 4095 /* Phase change points must fit in 12 bits */
+
+struct memo_entry_t {
+	uint64_t key; /* 0 if the entry is empty */
+	int misses;   /* 1 if the subset misses a deadline */
+};
+
+struct memo_cache_t {
+	int wcet[NUM_TASKS];   /* Task set that the entries are for */
+	int period[NUM_TASKS];
+	long lookups;   /* Statistics since the last report, see */
+	long hits;      /* record_prefilter_statistics() */
+	long evictions;
+	struct memo_entry_t entries[1 << MEMO_CACHE_BITS];
+};
+
+pthread_key_t memo_cache_key; /* Each thread has its own cache */
+pthread_once_t memo_cache_once = PTHREAD_ONCE_INIT;
+
+void create_memo_cache_key() {
+	if (pthread_key_create(&memo_cache_key, free) != 0) {
+		fprintf(stderr, "Could not create memo cache key.\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * Get the memo cache of the calling thread, or NULL if the thread has none.
+ */
+struct memo_cache_t *find_memo_cache() {
+	pthread_once(&memo_cache_once, create_memo_cache_key);
+	return pthread_getspecific(memo_cache_key);
+}
+
+/*
+ * Get the memo cache of the calling thread for the task set, creating it or
+ * clearing it if it was last used for another task set.
+ */
+struct memo_cache_t *get_memo_cache(struct taskset_t *ts) {
+	struct memo_cache_t *cache = find_memo_cache();
+	if (cache == NULL) {
+		cache = xmalloc(sizeof(struct memo_cache_t));
+		memset(cache, 0, sizeof(struct memo_cache_t));
+		if (pthread_setspecific(memo_cache_key, cache) != 0) {
+			fprintf(stderr, "Could not set memo cache.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+
+	int stale = 0;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		stale |= cache->wcet[i] != ts->tasks[i].wcet;
+		stale |= cache->period[i] != ts->tasks[i].period;
+	}
+	if (stale) {
+		memset(cache->entries, 0, sizeof(cache->entries));
+		for (int i = 0; i < NUM_TASKS; i++) {
+			cache->wcet[i] = ts->tasks[i].wcet;
+			cache->period[i] = ts->tasks[i].period;
+		}
+	}
+	return cache;
+}
+
+/*
+ * Get the cache key of the subset of the tasks i with in_subset[i] set: a bit
+ * for each task, which is set if the task is in the subset, and for each task
+ * in the subset its phase change point and the rank of its phase 1 and phase 2
+ * priorities among the priorities of the subset. Only this relative order
+ * matters within the subset. Each task in the subset takes 19 bits, so the key
+ * is unique for subsets of up to NUM_TASKS - 1 = 3 tasks, as prefilter_memo()
+ * uses.
+ */
+uint64_t get_memo_key(struct taskset_t *ts, const int *in_subset) {
+	uint64_t key = 0;
+	for (int i = NUM_TASKS - 1; i >= 0; i--) {
+		if (!in_subset[i]) {
+			key <<= 1; /* Task i is not in the subset */
+			continue;
+		}
+		int rank_1 = 0;
+		int rank_2 = 0;
+		for (int j = 0; j < NUM_TASKS; j++) {
+			if (in_subset[j]) {
+				rank_1 += ts->tasks[j].phase_1_prio <
+					ts->tasks[i].phase_1_prio;
+				rank_1 += ts->tasks[j].phase_2_prio <
+					ts->tasks[i].phase_1_prio;
+				rank_2 += ts->tasks[j].phase_1_prio <
+					ts->tasks[i].phase_2_prio;
+				rank_2 += ts->tasks[j].phase_2_prio <
+					ts->tasks[i].phase_2_prio;
+			}
+		}
+		key = (((key << 3 | rank_1) << 3 | rank_2) << 12) |
+			ts->tasks[i].phase_change_point;
+		key = key << 1 | 1; /* Task i is in the subset */
+	}
+	return key;
+}
+
+/*
+ * Check whether the subset of the tasks i with in_subset[i] set misses a
+ * deadline when simulated on its own, looking it up in the cache or else
+ * simulating it with simulate_sas(). The simulation only covers the first job
+ * of each task of the subset (up to its longest period), as a later miss is
+ * rare: simulating four times as long rejects only 0.05% more combinations.
+ */
+int memo_subset_misses(struct memo_cache_t *cache, struct taskset_t *ts,
+		const int *in_subset) {
+	uint64_t key = get_memo_key(ts, in_subset);
+	struct memo_entry_t *entry = &cache->entries[
+		(key * 0x9e3779b97f4a7c15ULL) >> (64 - MEMO_CACHE_BITS)];
+	cache->lookups++;
+	if (entry->key == key) {
+		cache->hits++;
+		return entry->misses;
+	}
+
+	/*
+	 * Tasks outside the subset release jobs without any work. The simulation
+	 * ends at the longest period of the subset (its "hyper-period" here).
+	 */
+	struct taskset_t subset = *ts;
+	subset.hyper_period = 0;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		if (!in_subset[i]) {
+			subset.tasks[i].wcet = 0;
+		} else if (subset.tasks[i].period > subset.hyper_period) {
+			subset.hyper_period = subset.tasks[i].period;
+		}
+	}
+	cache->evictions += entry->key != 0;
+	entry->key = key;
+	entry->misses = simulate_sas(&subset) != NULL;
+	return entry->misses;
+}
+
+/*
+ * Prefilter 4 (-m option): reject if a subset of the tasks misses a deadline
+ * on its own, where every priority that a job of the subset can have is
+ * higher than every priority that a job of the other tasks can have. The other
+ * tasks then never run while a job of the subset is active, so the subset has
+ * exactly the same schedule as in the SAS of all tasks, and a deadline miss of
+ * the subset is a deadline miss of the task set. The
+ * verdict for the subset only depends on its tasks, their phase change points
+ * and the relative order of their priorities, and is cached for reuse by
+ * other combinations and priority permutations (see memo_subset_misses()).
+ * If the subsets of more than one size qualify, the smallest ones are tried
+ * first, as their verdicts are shared by more combinations.
+ */
+int prefilter_memo(struct taskset_t *ts, const int *highest,
+		const int *lowest) {
+	int order[NUM_TASKS]; /* Tasks in order of highest priority */
+	int in_subset[NUM_TASKS];
+	for (int i = 0; i < NUM_TASKS; i++) {
+		if (ts->tasks[i].period > MEMO_MAX_PERIOD) {
+			return 0; /* Does not fit in the cache key */
+		}
+		int k = i;
+		for (; k > 0 && highest[order[k - 1]] > highest[i]; k--) {
+			order[k] = order[k - 1];
+		}
+		order[k] = i;
+		in_subset[i] = 0;
+	}
+
+	struct memo_cache_t *cache = get_memo_cache(ts);
+	int subset_lowest = -1; /* Lowest priority of a job of the subset */
+	for (int k = 0; k < NUM_TASKS - 1; k++) {
+		in_subset[order[k]] = 1;
+		if (lowest[order[k]] > subset_lowest) {
+			subset_lowest = lowest[order[k]];
+		}
+		if (subset_lowest < highest[order[k + 1]] &&
+				memo_subset_misses(cache, ts, in_subset)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+const char *prefilter_names[NUM_PREFILTERS] = {
+	"pair", "rta", "phase 2", "memo"
+};
+int (*const prefilters[NUM_PREFILTERS])(struct taskset_t *, const int *,
+		const int *) = {
+	prefilter_pair, prefilter_rta, prefilter_phase_2, prefilter_memo
+};
+
+/*
+ * Check whether prefilter k is used: the memo prefilter with the -m option,
+ * and the others with the -f option.
+ */
+int is_prefilter_enabled(int k) {
+	return k == NUM_PREFILTERS - 1 ? options.memoize : options.prefilter;
+}
+
+/*
+ * Check whether any prefilter is used.
+ */
+int any_prefilter_enabled() {
+	return options.prefilter || options.memoize;
+}
+
+/*
+ * Run the prefilters in order on the current phase change points of the task
+ * set, until one of them rejects the combination, and count this in stats.
+ *
+ * Returns 1 if the combination is rejected (and provably misses a deadline),
+ * otherwise returns 0.
+ */
+int is_rejected_by_prefilters(struct taskset_t *ts,
+		struct prefilter_stats_t *stats) {
+	int highest[NUM_TASKS], lowest[NUM_TASKS];
+	for (int i = 0; i < NUM_TASKS; i++) {
+		get_priority_range(&ts->tasks[i], &highest[i], &lowest[i]);
+	}
+	for (int k = 0; k < NUM_PREFILTERS; k++) {
+		if (!is_prefilter_enabled(k)) {
+			continue;
+		}
+		stats->checked[k]++;
+		if (prefilters[k](ts, highest, lowest)) {
+			stats->rejected[k]++;
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Add the prefilter statistics of one priority permutation to the search,
+ * along with the use of the memo cache of the calling thread since the last
+ * time.
+ */
+void record_prefilter_statistics(struct prefilter_stats_t *stats) {
+	struct memo_cache_t *cache = find_memo_cache();
+	pthread_mutex_lock(&search.lock);
+	for (int k = 0; k < NUM_PREFILTERS; k++) {
+		search.prefilter_stats.checked[k] += stats->checked[k];
+		search.prefilter_stats.rejected[k] += stats->rejected[k];
+	}
+	if (cache != NULL) {
+		search.prefilter_stats.memo_lookups += cache->lookups;
+		search.prefilter_stats.memo_hits += cache->hits;
+		search.prefilter_stats.memo_evictions += cache->evictions;
+		cache->lookups = cache->hits = cache->evictions = 0;
+	}
+	pthread_mutex_unlock(&search.lock);
+}
+
+/*
+ * Get the number of combinations rejected by any prefilter.
+ */
+long get_prefilter_rejections(struct prefilter_stats_t *stats) {
+	long rejected = 0;
+	for (int k = 0; k < NUM_PREFILTERS; k++) {
+		rejected += stats->rejected[k];
+	}
+	return rejected;
+}
+
+/*
+ * Print the hit rate of each prefilter that is used. Each prefilter only
+ * checks the combinations that passed the ones before it.
+ */
+void print_prefilter_statistics(struct prefilter_stats_t *stats) {
+	long checked = 0; /* By the first prefilter, i.e., all combinations */
+	for (int k = 0; k < NUM_PREFILTERS; k++) {
+		if (!is_prefilter_enabled(k)) {
+			continue;
+		}
+		if (checked == 0) {
+			checked = stats->checked[k];
+		}
+		printf("Prefilter %s: rejected %ld of %ld checked combinations "
+				"(%.1f%%).\n",
+				prefilter_names[k],
+				stats->rejected[k],
+				stats->checked[k],
+				stats->checked[k] > 0 ?
+				100.0 * stats->rejected[k] / stats->checked[k] : 0.0);
+	}
+	if (options.memoize) {
+		printf("Memo cache: %ld hits in %ld lookups (%.1f%%), %ld evictions "
+				"from %d entries per thread.\n",
+				stats->memo_hits,
+				stats->memo_lookups,
+				stats->memo_lookups > 0 ?
+				100.0 * stats->memo_hits / stats->memo_lookups : 0.0,
+				stats->memo_evictions,
+				1 << MEMO_CACHE_BITS);
+	}
+	printf("Prefilters: %ld combinations left to simulate.\n\n",
+			checked - get_prefilter_rejections(stats));
+}
+
+/*
+ * ============================================================================
+ * Per-worker contexts of the searches.
+ *
+ * Each worker thread simulates on its own copy of the task set and keeps its
+ * own scratch state. All contexts are allocated once, before the workers
+ * start, as one block of memory (the arena) in which each worker has a
+ * context of the same size. The contexts start at cache line boundaries and
+ * are padded to whole cache lines, so no two workers ever write to the same
+ * cache line. Each worker clears its own context when it starts, which is the
+ * first write to that memory. With the --numa-local option, the contexts are
+ * also padded to whole pages, so that the first-touch policy of the operating
+ * system places each of them on the NUMA node of its worker.
+ * ============================================================================
+ */
+
+#define CACHE_LINE_SIZE 64
+
+/*
+ * Context of one worker. The memo cache (-m option) and the arrays of the
+ * order of the phase change points (--order option) follow the context in
+ * the arena, but only if the search needs them.
+ */
+struct worker_t {
+	struct taskset_t ts; /* Own copy of the task set */
+	struct dispatch_table_t dispatch_table; /* -e table */
+	struct memo_cache_t *memo_cache; /* -m, otherwise NULL */
+	struct pcp_order_t order;        /* --order, otherwise all NULL */
+	struct dispatch_table_t *saved_dispatch_table; /* Of the thread before */
+	struct memo_cache_t *saved_memo_cache;
+	long simulations; /* Statistics of the scaling benchmark */
+	double busy_seconds; /* Time spent on chunks of the permutation search */
+};
+
+/*
+ * Memory of the contexts of all workers, with the context of worker w at
+ * memory + w * context_size.
+ */
+struct worker_arena_t {
+	char *memory;
+	size_t context_size; /* A multiple of the alignment of the contexts */
+};
+
+struct worker_arena_t worker_arena = {NULL, 0};
+
+/*
+ * Round size up to a multiple of alignment.
+ */
+size_t align_size(size_t size, size_t alignment) {
+	return (size + alignment - 1) / alignment * alignment;
+}
+
+/*
+ * Get the size of a worker context with everything that it needs for a
+ * search of the task set ts, or for a sweep if ts is NULL.
+ */
+size_t get_worker_context_size(struct taskset_t *ts) {
+	size_t size = align_size(sizeof(struct worker_t), CACHE_LINE_SIZE);
+	if (ts != NULL && options.memoize) {
+		size += align_size(sizeof(struct memo_cache_t), CACHE_LINE_SIZE);
+	}
+	if (ts != NULL && options.order != ORDER_UP) {
+		for (int i = 0; i < NUM_TASKS; i++) {
+			size += align_size((ts->tasks[i].period + 1) * sizeof(int),
+					CACHE_LINE_SIZE);
+		}
+	}
+	return size;
+}
+
+/*
+ * Allocate the contexts of num_workers workers in the arena, for a search of
+ * the task set ts, or for a sweep if ts is NULL.
+ */
+void create_worker_arena(struct worker_arena_t *arena, int num_workers,
+		struct taskset_t *ts) {
+	size_t alignment = CACHE_LINE_SIZE;
+	if (options.numa_local) {
+		alignment = sysconf(_SC_PAGESIZE);
+	}
+	arena->context_size = align_size(get_worker_context_size(ts), alignment);
+	void *memory;
+	if (posix_memalign(&memory, alignment,
+				num_workers * arena->context_size) != 0) {
+		fprintf(stderr, "Could not allocate the worker contexts.\n");
+		exit(EXIT_FAILURE);
+	}
+	arena->memory = memory;
+}
+
+void destroy_worker_arena(struct worker_arena_t *arena) {
+	free(arena->memory);
+	arena->memory = NULL;
+}
+
+/*
+ * Get the context of worker w in the arena.
+ */
+struct worker_t *get_worker(struct worker_arena_t *arena, int w) {
+	return (struct worker_t *)(arena->memory + w * arena->context_size);
+}
+
+/*
+ * Set up the context of worker w in the arena, in the thread of the worker,
+ * with a copy of the task set ts (or of nothing, for a sweep). The dispatch
+ * table and memo cache of the context become those of the calling thread,
+ * until release_worker() is called.
+ */
+struct worker_t *init_worker(struct worker_arena_t *arena, int w,
+		struct taskset_t *ts) {
+	struct worker_t *worker = get_worker(arena, w);
+	memset(worker, 0, arena->context_size);
+	char *memory = (char *)worker;
+	memory += align_size(sizeof(struct worker_t), CACHE_LINE_SIZE);
+	if (ts != NULL) {
+		worker->ts = *ts;
+	}
+	if (ts != NULL && options.memoize) {
+		worker->memo_cache = (struct memo_cache_t *)memory;
+		memory += align_size(sizeof(struct memo_cache_t), CACHE_LINE_SIZE);
+	}
+	if (ts != NULL && options.order != ORDER_UP) {
+		for (int i = 0; i < NUM_TASKS; i++) {
+			worker->order.pcps[i] = (int *)memory;
+			memory += align_size((ts->tasks[i].period + 1) * sizeof(int),
+					CACHE_LINE_SIZE);
+		}
+	}
+	assert(memory <= (char *)worker + arena->context_size);
+
+	pthread_once(&dispatch_table_once, create_dispatch_table_key);
+	worker->saved_dispatch_table = pthread_getspecific(dispatch_table_key);
+	worker->saved_memo_cache = find_memo_cache();
+	if (pthread_setspecific(dispatch_table_key,
+				&worker->dispatch_table) != 0 ||
+			(worker->memo_cache != NULL &&
+			 pthread_setspecific(memo_cache_key, worker->memo_cache) != 0)) {
+		fprintf(stderr, "Could not set the worker context.\n");
+		exit(EXIT_FAILURE);
+	}
+	return worker;
+}
+
+/*
+ * Give the calling thread back the dispatch table and memo cache that it had
+ * before init_worker(), as the arena may be freed before the thread exits.
+ */
+void release_worker(struct worker_t *worker) {
+	if (pthread_setspecific(dispatch_table_key,
+				worker->saved_dispatch_table) != 0 ||
+			pthread_setspecific(memo_cache_key,
+				worker->saved_memo_cache) != 0) {
+		fprintf(stderr, "Could not release the worker context.\n");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * ============================================================================
+ * Functions for exhaustively testing dual-priority schedulability.
+ *
+ * The below functionality is written in a naive style and is hard coded for
+ * NUM_TASKS = 4 (which holds for all the counterexamples). For example, many
+ * simple loops are unrolled, and combinations and permutations are generated
+ * using nested for-loops instead of using more sophisticated methods.
+ *
+ * The intent with this naive coding is that it should be as easy as possible
+ * for a (human) reader to verify the correctness of the code.
+ * ============================================================================
+ */
+
+/*
+ * Test the task set with the FDMS policy like test_fdms_phase_change_points(),
+ * but resume each simulation after the first instead of restarting it at time
+ * point 0 (-s option).
+ *
+ * Decreasing the phase change point of a task from p to p - 1 cannot change
+ * the schedule before the first time point at which the task has an active job
+ * of age p - 1. The simulations therefore record snapshots at the first time
+ * point at which each task has an active job of each age below its phase
+ * change point, and the next simulation resumes from the snapshot for the
+ * decreased phase change point. The snapshots after it are discarded, and are
+ * recorded again by the resumed simulation. Each snapshot is the first one for
+ * some age of some task, so there are at most as many as the sum of the
+ * periods.
+ */
+int test_fdms_phase_change_points_incremental(struct taskset_t *ts) {
+	struct fdms_snapshots_t fdms;
+	long max_snapshots = 0;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		ts->tasks[i].phase_change_point = ts->tasks[i].period;
+		fdms.first[i] = xmalloc(ts->tasks[i].period * sizeof(long));
+		fdms.recorded[i] = 0;
+		max_snapshots += ts->tasks[i].period;
+	}
+	fdms.snapshots = xmalloc(max_snapshots * sizeof(struct snapshot_t));
+	fdms.num_snapshots = 0;
+	fdms.next_time = 0;
+
+	struct snapshot_t *resume_from = NULL;
+	struct task_t *miss_task;
+	int schedulable;
+	while (1) {
+		miss_task = simulate_sas_resumable(ts, resume_from, 0, NULL,
+				options.engine == ENGINE_EVENT, &fdms);
+		if (miss_task == NULL) { /* No deadline miss, return success */
+			schedulable = 1;
+			break;
+		} else if (miss_task->phase_change_point > 0) { /* Decrease point */
+			miss_task->phase_change_point--;
+			int i = miss_task - ts->tasks;
+			assert(fdms.recorded[i] > miss_task->phase_change_point);
+			long last = fdms.first[i][miss_task->phase_change_point];
+			discard_fdms_snapshots(&fdms, last);
+			resume_from = &fdms.snapshots[last];
+		} else { /* Phase change point already zero, return failure */
+			schedulable = 0;
+			break;
+		}
+	}
+
+	for (int i = 0; i < NUM_TASKS; i++) {
+		free(fdms.first[i]);
+	}
+	free(fdms.snapshots);
+	return schedulable;
+}
+
+/*
+ * Test whether the task set is dual-priority schedulable with the current 
+ * priorities and phase change points set according to the FDMS policy.
+ *
+ * Returns 1 if the task set is schedulable using this policy, 0 otherwise.
+ *
+ * Precondition: The task set has four tasks, with phase 1 and phase 2
+ *               priorities already set.
+ *
+ * The FDMS policy works as follows.
+ *
+ * (1) All the phase change points are set equal to the corresponding periods.
+ * (2) The SAS is simulated for one hyper-period, or until a deadline miss.
+ * (3) If there are no deadline misses in (2), the task set is schedulable.
+ *     Otherwise, the phase change point of the first task to miss its deadline
+ *     is decreased by 1. If the phase change point of that task was already 0,
+ *     then the FDMS policy fails. Otherwise, repeat from (2).
+ */
+int test_fdms_phase_change_points(struct taskset_t *ts) {
+	if (options.snapshots) {
+		return test_fdms_phase_change_points_incremental(ts);
+	}
+
+	ts->tasks[0].phase_change_point = ts->tasks[0].period;
+	ts->tasks[1].phase_change_point = ts->tasks[1].period;
+	ts->tasks[2].phase_change_point = ts->tasks[2].period;
+	ts->tasks[3].phase_change_point = ts->tasks[3].period;
+
+	struct task_t *miss_task;
+	while (1) {
+		miss_task = simulate(ts);
+		if (miss_task == NULL) { /* No deadline miss, return success */
+			return 1;
+		} else if (miss_task->phase_change_point > 0) { /* Decrease point */
+			miss_task->phase_change_point--;
+		} else { /* Phase change point already zero, return failure */
+			return 0;
+		}
+	}
+}
+
+/*
+ * Test whether the task set is dual-priority schedulable with any setting
+ * of the phase change points with the current priority ordering. The phase
+ * change point of each task will range between 0 and the task's period. Works
+ * by simulating the SAS until the first deadline miss for all settings of the 
+ * phase change points, or until a schedulable configuration is found. 
+ *
+ * Returns 1 if any schedulable configuration of the phase change points exists
+ * with the current priorities, returns 0 otherwise.
+ *
+ * The test starts at the phase change points in the cursor (all 0, unless
+ * resuming from a checkpoint), and records its progress in the cursor.
+ *
+ * Precondition: The task set has four tasks, with phase 1 and phase 2
+ *               priorities already set.
+ */
+int test_all_phase_change_points(struct taskset_t *ts,
+		struct cursor_t *cursor) {
+	const long total_combinations = count_combinations(ts);
+	long generated_combinations = combinations_before(ts, cursor);
+	struct snapshot_t prefix; /* Schedule prefix to reuse (-s option) */
+	struct prefilter_stats_t prefilter_stats = {{0}, {0}, 0, 0, 0}; /* -f, -m */
+	int resuming = 1; /* Start the loops at the cursor */
+	int T1end; /* End of the chunk of phase change points of T1 */
+
+	if (options.output == OUTPUT_FULL) {
+		lock_output();
+		printf("Testing all %ld possible combinations of phase change "
+				"points...\n", total_combinations);
+		unlock_output();
+	}
+
+	/*
+	 * Naively generate all combinations of phase change points.
+	 * T1pcp becomes the phase change point of task T1 etc.
+	 */
+	for (int T1pcp = advance_chunk(cursor, cursor->phase_change_point[0],
+				&T1end);
+			T1pcp < T1end; T1pcp = advance_chunk(cursor, T1pcp + 1, &T1end)) {
+		ts->tasks[0].phase_change_point = T1pcp;
+
+		for (int T2pcp = resuming ? cursor->phase_change_point[1] : 0;
+				T2pcp <= ts->tasks[1].period; T2pcp++) {
+			ts->tasks[1].phase_change_point = T2pcp;
+
+			for (int T3pcp = resuming ? cursor->phase_change_point[2] : 0;
+					T3pcp <= ts->tasks[2].period; T3pcp++) {
+				ts->tasks[2].phase_change_point = T3pcp;
+				resuming = 0;
+
+				if (search_is_stopped(cursor, ts)) {
+					return 0; /* Another worker found a valid setting. */
+				}
+
+				prefix.t = -1; /* Nothing to reuse with new T1pcp..T3pcp */
+
+				for (int T4pcp = 0; T4pcp <= ts->tasks[3].period; T4pcp++) {
+					ts->tasks[3].phase_change_point = T4pcp;
+
+					generated_combinations++;
+					
+					if (VERBOSE) {
+						lock_output();
+						printf("Testing phase change point combination "
+								"%ld of %ld...\n",
+								generated_combinations,
+							   	total_combinations);
+						print_taskset(ts, 1, 1);
+						unlock_output();
+					}
+					if (any_prefilter_enabled() &&
+							is_rejected_by_prefilters(ts, &prefilter_stats)) {
+						continue; /* Provably unschedulable */
+					}
+					if (simulate_reusing_prefix(ts, &prefix) == NULL) {
+						/* SAS is schedulable */
+						print_witness(ts);
+						record_prefilter_statistics(&prefilter_stats);
+						return 1; /* Return if a valid setting is found. */
+					} else if (VERBOSE) {
+						lock_output();
+						printf("Unschedulable with this configuration.\n\n");
+						unlock_output();
+					}
+				}
+			}
+		}
+	}
+	assert(generated_combinations == combinations_before_chunk_end(ts, T1end));
+	record_prefilter_statistics(&prefilter_stats);
+	return 0; /* Not schedulable with any promotion points. */
+}
+
+/*
+ * Get the next phase change point of task i to test when pruning, given that
+ * the current one is ts->tasks[i].phase_change_point and that min_age is the
+ * smallest min_phase_2_age of task i over all the simulations made for it.
+ * The number of combinations skipped by this is added to *skipped.
+ *
+ * If no simulation had an active job of task i in phase 2 at an age below
+ * min_age, then making the phase change point later, but at most min_age,
+ * changes no priority of an active job before the deadline miss. All those
+ * phase change points would thus give identical schedules up to the same
+ * deadline misses as those already simulated, and can be skipped.
+ */
+int next_pruned_phase_change_point(struct taskset_t *ts, int i, long min_age,
+		long *skipped) {
+	int pcp = ts->tasks[i].phase_change_point;
+	int next_pcp = ts->tasks[i].period + 1; /* Skip all remaining */
+	if (min_age < ts->tasks[i].period) {
+		next_pcp = min_age + 1;
+	}
+	assert(next_pcp > pcp);
+
+	long inner_combinations = 1; /* Combinations for each value of task i */
+	for (int j = i + 1; j < NUM_TASKS; j++) {
+		inner_combinations *= ts->tasks[j].period + 1;
+	}
+	*skipped += (next_pcp - pcp - 1) * inner_combinations;
+	return next_pcp;
+}
+
+/*
+ * Get the next phase change point of T1 to test when pruning, like
+ * next_pruned_phase_change_point(), and move the worker with the given cursor
+ * on to it (see advance_chunk()). Only the combinations up to the end of the
+ * chunk, which is stored in *end, count as skipped.
+ */
+int next_pruned_chunk_phase_change_point(struct taskset_t *ts,
+		struct cursor_t *cursor, long min_age, int *end, long *skipped) {
+	int next_pcp = next_pruned_phase_change_point(ts, 0, min_age, skipped);
+	int pcp = advance_chunk(cursor, next_pcp, end);
+	*skipped -= (next_pcp - pcp) * combinations_before_chunk_end(ts, 1);
+	return pcp;
+}
+
+/*
+ * Print and record the pruning statistics of one priority permutation.
+ */
+void record_pruning_statistics(long simulated_combinations,
+		long skipped_combinations, long total_combinations) {
+	if (options.output == OUTPUT_FULL) {
+		lock_output();
+		printf("Simulated %ld and skipped %ld of %ld combinations.\n",
+				simulated_combinations,
+				skipped_combinations,
+				total_combinations);
+		unlock_output();
+	}
+
+	pthread_mutex_lock(&search.lock);
+	search.simulated_combinations += simulated_combinations;
+	search.skipped_combinations += skipped_combinations;
+	pthread_mutex_unlock(&search.lock);
+}
+
+/*
+ * Same as test_all_phase_change_points(), but skips the combinations of phase
+ * change points that provably give the same deadline miss as an already
+ * simulated one (see next_pruned_phase_change_point()). Used with the -p
+ * option.
+ *
+ * For each loop below, min_age[i] is the smallest min_phase_2_age of task i
+ * over all simulations made with the current value of Tipcp. Skipped
+ * combinations are equivalent to simulated ones, so these minimums are the
+ * same as if every combination had been simulated. When resuming from a
+ * checkpoint, the simulations before the cursor are unknown, so nothing is
+ * skipped after the values of the cursor.
+ */
+int test_all_phase_change_points_pruned(struct taskset_t *ts,
+		struct cursor_t *cursor) {
+	const long total_combinations = count_combinations(ts);
+	long simulated_combinations = 0;
+	long skipped_combinations = 0;
+	long resumed_combinations = combinations_before(ts, cursor);
+	long min_age[NUM_TASKS];
+	struct snapshot_t prefix; /* Schedule prefix to reuse (-s option) */
+	struct prefilter_stats_t prefilter_stats = {{0}, {0}, 0, 0, 0}; /* -f, -m */
+	int resuming = resumed_combinations > 0; /* Start the loops at the cursor */
+	int T1end; /* End of the chunk of phase change points of T1 */
+
+	if (options.output == OUTPUT_FULL) {
+		lock_output();
+		printf("Testing all %ld possible combinations of phase change points "
+				"with pruning...\n", total_combinations);
+		unlock_output();
+	}
+
+	for (int T1pcp = advance_chunk(cursor, cursor->phase_change_point[0],
+				&T1end);
+			T1pcp < T1end;
+			T1pcp = next_pruned_chunk_phase_change_point(ts, cursor,
+				min_age[0], &T1end, &skipped_combinations)) {
+		ts->tasks[0].phase_change_point = T1pcp;
+		min_age[0] = resuming ? T1pcp : LONG_MAX;
+
+		for (int T2pcp = resuming ? cursor->phase_change_point[1] : 0;
+				T2pcp <= ts->tasks[1].period;
+				T2pcp = next_pruned_phase_change_point(ts, 1, min_age[1],
+					&skipped_combinations)) {
+			ts->tasks[1].phase_change_point = T2pcp;
+			min_age[1] = resuming ? T2pcp : LONG_MAX;
+
+			for (int T3pcp = resuming ? cursor->phase_change_point[2] : 0;
+					T3pcp <= ts->tasks[2].period;
+					T3pcp = next_pruned_phase_change_point(ts, 2, min_age[2],
+						&skipped_combinations)) {
+				ts->tasks[2].phase_change_point = T3pcp;
+				min_age[2] = resuming ? T3pcp : LONG_MAX;
+				resuming = 0;
+
+				if (search_is_stopped(cursor, ts)) {
+					return 0; /* Another worker found a valid setting. */
+				}
+
+				prefix.t = -1; /* Nothing to reuse with new T1pcp..T3pcp */
+
+				for (int T4pcp = 0; T4pcp <= ts->tasks[3].period;
+						T4pcp = next_pruned_phase_change_point(ts, 3,
+							min_age[3], &skipped_combinations)) {
+					ts->tasks[3].phase_change_point = T4pcp;
+					min_age[3] = LONG_MAX;
+
+					/*
+					 * The ages in phase 2 of a rejected combination are not
+					 * known, so nothing may be skipped after it.
+					 */
+					if (any_prefilter_enabled() &&
+							is_rejected_by_prefilters(ts, &prefilter_stats)) {
+						for (int i = 0; i < NUM_TASKS; i++) {
+							if (ts->tasks[i].phase_change_point < min_age[i]) {
+								min_age[i] = ts->tasks[i].phase_change_point;
+							}
+						}
+						continue; /* Provably unschedulable */
+					}
+
+					simulated_combinations++;
+					if (simulate_reusing_prefix(ts, &prefix) == NULL) {
+						/* SAS is schedulable */
+						print_witness(ts);
+						record_pruning_statistics(simulated_combinations,
+								skipped_combinations, total_combinations);
+						record_prefilter_statistics(&prefilter_stats);
+						return 1; /* Return if a valid setting is found. */
+					}
+					for (int i = 0; i < NUM_TASKS; i++) {
+						if (ts->tasks[i].min_phase_2_age < min_age[i]) {
+							min_age[i] = ts->tasks[i].min_phase_2_age;
+						}
+					}
+				}
+			}
+		}
+	}
+	assert(resumed_combinations + simulated_combinations +
+			skipped_combinations + get_prefilter_rejections(&prefilter_stats) ==
+			combinations_before_chunk_end(ts, T1end));
+	record_pruning_statistics(simulated_combinations, skipped_combinations,
+			total_combinations);
+	record_prefilter_statistics(&prefilter_stats);
+	return 0; /* Not schedulable with any promotion points. */
+}
+
+/*
+ * Same as test_all_phase_change_points(), but simulates BATCH_LANES phase
+ * change points of T4 at a time with simulate_sas_batch(). Used with the
+ * -e simd option. The first schedulable lane of a batch has the lowest phase
+ * change point, so the same configuration is found as without batching.
+ *
+ * Falls back to test_all_phase_change_points() if the periods are too large
+ * for the compact representation.
+ */
+int test_all_phase_change_points_batched(struct taskset_t *ts,
+		struct cursor_t *cursor) {
+	if (!is_compactable(ts)) {
+		return test_all_phase_change_points(ts, cursor);
+	}
+
+	const long total_combinations = count_combinations(ts);
+	long generated_combinations = combinations_before(ts, cursor);
+	int resuming = 1; /* Start the loops at the cursor */
+	int T1end; /* End of the chunk of phase change points of T1 */
+	struct compact_taskset_t cts;
+	uint8_t T4pcps[BATCH_LANES];
+	struct prefilter_stats_t prefilter_stats = {{0}, {0}, 0, 0, 0}; /* -f, -m */
+
+	if (options.output == OUTPUT_FULL) {
+		lock_output();
+		printf("Testing all %ld possible combinations of phase change points "
+				"in batches of %d...\n", total_combinations, BATCH_LANES);
+		unlock_output();
+	}
+
+	for (int T1pcp = advance_chunk(cursor, cursor->phase_change_point[0],
+				&T1end);
+			T1pcp < T1end; T1pcp = advance_chunk(cursor, T1pcp + 1, &T1end)) {
+		ts->tasks[0].phase_change_point = T1pcp;
+
+		for (int T2pcp = resuming ? cursor->phase_change_point[1] : 0;
+				T2pcp <= ts->tasks[1].period; T2pcp++) {
+			ts->tasks[1].phase_change_point = T2pcp;
+
+			for (int T3pcp = resuming ? cursor->phase_change_point[2] : 0;
+					T3pcp <= ts->tasks[2].period; T3pcp++) {
+				ts->tasks[2].phase_change_point = T3pcp;
+				resuming = 0;
+
+				if (search_is_stopped(cursor, ts)) {
+					return 0; /* Another worker found a valid setting. */
+				}
+				compact_taskset(&cts, ts);
+
+				/*
+				 * Fill the lanes with the phase change points of T4 in order,
+				 * leaving out those rejected by the prefilters (-f option).
+				 */
+				int T4pcp = 0;
+				while (T4pcp <= ts->tasks[3].period) {
+					int num_lanes = 0;
+					for (; T4pcp <= ts->tasks[3].period &&
+							num_lanes < BATCH_LANES; T4pcp++) {
+						ts->tasks[3].phase_change_point = T4pcp;
+						generated_combinations++;
+						if (any_prefilter_enabled() &&
+								is_rejected_by_prefilters(ts,
+									&prefilter_stats)) {
+							continue; /* Provably unschedulable */
+						}
+						T4pcps[num_lanes] = T4pcp;
+						num_lanes++;
+					}
+					if (num_lanes == 0) {
+						continue;
+					}
+
+					COUNT_BATCHED_SIMULATIONS(ts, num_lanes);
+					int lane = simulate_sas_batch(&cts, T4pcps, num_lanes);
+					if (lane >= 0) { /* SAS is schedulable in this lane */
+						ts->tasks[3].phase_change_point = T4pcps[lane];
+						print_witness(ts);
+						record_prefilter_statistics(&prefilter_stats);
+						return 1; /* Return if a valid setting is found. */
+					}
+				}
+			}
+		}
+	}
+	assert(generated_combinations == combinations_before_chunk_end(ts, T1end));
+	record_prefilter_statistics(&prefilter_stats);
+	return 0; /* Not schedulable with any promotion points. */
+}
+
+/*
+ * Get the distance of phase change point pcp of the task from those that the
+ * order of the --order option tests first, given the center of the order.
+ */
+int get_order_distance(struct task_t *task, int center, int pcp) {
+	int distance = abs(pcp - center);
+	if (options.order == ORDER_RANKED && abs(pcp - task->wcet) < distance) {
+		distance = abs(pcp - task->wcet);
+	}
+	return distance;
+}
+
+/*
+ * Set up the order of the phase change points of the task set with its
+ * current priorities. Each task's are sorted by their distance from the
+ * center of the order, which is half the period or those of the FDMS policy
+ * (even if it fails), and ties are broken by the smaller phase change point.
+ * Each order is a permutation of 0..period, so no combination is left out.
+ * The arrays of the order must already be allocated (see init_worker()).
+ */
+void init_pcp_order(struct pcp_order_t *order, struct taskset_t *ts) {
+	int center[NUM_TASKS];
+	if (options.order == ORDER_FDMS) {
+		struct taskset_t fdms = *ts;
+		test_fdms_phase_change_points(&fdms);
+		for (int i = 0; i < NUM_TASKS; i++) {
+			center[i] = fdms.tasks[i].phase_change_point;
+		}
+	} else {
+		for (int i = 0; i < NUM_TASKS; i++) {
+			center[i] = ts->tasks[i].period / 2;
+		}
+	}
+
+	for (int i = 0; i < NUM_TASKS; i++) {
+		struct task_t *task = &ts->tasks[i];
+		int *pcps = order->pcps[i];
+		for (int pcp = 0; pcp <= task->period; pcp++) { /* Insertion sort */
+			int distance = get_order_distance(task, center[i], pcp);
+			int k = pcp;
+			while (k > 0 &&
+					get_order_distance(task, center[i], pcps[k - 1]) >
+					distance) {
+				pcps[k] = pcps[k - 1];
+				k--;
+			}
+			pcps[k] = pcp;
+		}
+	}
+}
+
+/*
+ * Same as test_all_phase_change_points(), but tests the phase change points of
+ * each task in the order of the --order option instead of from 0 up, to find
+ * a schedulable combination sooner, using the arrays of the given order. The
+ * loops run over positions in the order, which are also what the cursor and
+ * the chunks of T1 hold. With the -s option, a schedule prefix is only reused
+ * when the phase change point of T4 has increased.
+ */
+int test_all_phase_change_points_ordered(struct taskset_t *ts,
+		struct cursor_t *cursor, struct pcp_order_t *order) {
+	const long total_combinations = count_combinations(ts);
+	long generated_combinations = combinations_before(ts, cursor);
+	struct snapshot_t prefix; /* Schedule prefix to reuse (-s option) */
+	struct prefilter_stats_t prefilter_stats = {{0}, {0}, 0, 0, 0}; /* -f, -m */
+	int position[NUM_TASKS]; /* Of the current phase change points */
+	int resuming = 1; /* Start the loops at the cursor */
+	int T1end; /* End of the chunk of positions of T1 */
+
+	if (options.output == OUTPUT_FULL) {
+		lock_output();
+		printf("Testing all %ld possible combinations of phase change points "
+				"in the chosen order...\n", total_combinations);
+		unlock_output();
+	}
+
+	init_pcp_order(order, ts);
+	for (position[0] = advance_chunk(cursor, cursor->phase_change_point[0],
+				&T1end);
+			position[0] < T1end;
+			position[0] = advance_chunk(cursor, position[0] + 1, &T1end)) {
+		ts->tasks[0].phase_change_point = order->pcps[0][position[0]];
+
+		for (position[1] = resuming ? cursor->phase_change_point[1] : 0;
+				position[1] <= ts->tasks[1].period; position[1]++) {
+			ts->tasks[1].phase_change_point = order->pcps[1][position[1]];
+
+			for (position[2] = resuming ? cursor->phase_change_point[2] : 0;
+					position[2] <= ts->tasks[2].period; position[2]++) {
+				ts->tasks[2].phase_change_point = order->pcps[2][position[2]];
+				resuming = 0;
+
+				if (search_is_stopped_at(cursor, position)) {
+					return 0; /* Another worker found a valid setting. */
+				}
+
+				prefix.t = -1; /* Nothing to reuse with new T1pcp..T3pcp */
+
+				for (position[3] = 0; position[3] <= ts->tasks[3].period;
+						position[3]++) {
+					int T4pcp = order->pcps[3][position[3]];
+					if (T4pcp < ts->tasks[3].phase_change_point) {
+						prefix.t = -1; /* Only valid for later ones */
+					}
+					ts->tasks[3].phase_change_point = T4pcp;
+					generated_combinations++;
+
+					if (any_prefilter_enabled() &&
+							is_rejected_by_prefilters(ts, &prefilter_stats)) {
+						continue; /* Provably unschedulable */
+					}
+					if (simulate_reusing_prefix(ts, &prefix) == NULL) {
+						/* SAS is schedulable */
+						print_witness(ts);
+						record_prefilter_statistics(&prefilter_stats);
+						return 1; /* Return if a valid setting is found. */
+					}
+				}
+			}
+		}
+	}
+	assert(generated_combinations == combinations_before_chunk_end(ts, T1end));
+	record_prefilter_statistics(&prefilter_stats);
+	return 0; /* Not schedulable with any promotion points. */
+}
+
+/*
+ * ============================================================================
+ * Experimental bisection of the phase change points (-b option).
+ *
+ * Instead of testing every phase change point of each task, the search makes
+ * a binary search over them, guided by the first task to miss a deadline. If
+ * task i was the first to miss, its phase change point was probably too late.
+ * If the first to miss was a task j with a priority between the two priorities
+ * of task i, which task i only preempts in phase 2, it was probably too early.
+ * When the simulations for one phase change point of task i give both kinds of
+ * misses, the schedulability is not monotone in it, and the remaining phase
+ * change points of task i are scanned linearly instead. When they give neither
+ * kind, the misses do not depend on task i and its other phase change points
+ * are skipped.
+ *
+ * A schedulable configuration found this way is real, as it was simulated,
+ * but a task set for which none is found may still be schedulable. The
+ * exhaustive search stays the only proof, and the counterexamples must be
+ * verified without -b.
+ * ============================================================================
+ */
+
+/*
+ * State of one bisection. Bit i of reordered_with[j] is set if the phase
+ * change of task i changes its order of priority with task j.
+ */
+struct bisection_t {
+	int reordered_with[NUM_TASKS];
+	long simulations; /* Combinations simulated */
+	long fallbacks;   /* Linear scans after a non-monotone result */
+};
+
+/*
+ * Check whether x lies strictly between the priorities a and b.
+ */
+int is_between(int a, int b, int x) {
+	return (a < x && x < b) || (b < x && x < a);
+}
+
+/*
+ * Set up a bisection of the phase change points of the task set with its
+ * current priorities.
+ */
+void init_bisection(struct bisection_t *bisection, struct taskset_t *ts) {
+	for (int j = 0; j < NUM_TASKS; j++) {
+		struct task_t *task_j = &ts->tasks[j];
+		bisection->reordered_with[j] = 0;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			struct task_t *task_i = &ts->tasks[i];
+			if (i != j && (is_between(task_i->phase_1_prio,
+							task_i->phase_2_prio, task_j->phase_1_prio) ||
+						is_between(task_i->phase_1_prio,
+							task_i->phase_2_prio, task_j->phase_2_prio))) {
+				bisection->reordered_with[j] |= 1 << i;
+			}
+		}
+	}
+	bisection->simulations = 0;
+	bisection->fallbacks = 0;
+}
+
+int scan_phase_change_points(struct taskset_t *ts, int i, int first, int last,
+		int skip, struct bisection_t *bisection, int *too_late,
+		int *too_early);
+
+/*
+ * Search the phase change points of tasks i and up by bisection, with those of
+ * the tasks before i fixed. For every simulation without success, the bit of
+ * each task whose phase change point was probably too late is set in
+ * *too_late, and that of each task whose phase change point was probably too
+ * early in *too_early.
+ *
+ * Returns 1, with the phase change points set, if a schedulable combination is
+ * found, otherwise returns 0.
+ */
+int bisect_phase_change_points(struct taskset_t *ts, int i,
+		struct bisection_t *bisection, int *too_late, int *too_early) {
+	if (i == NUM_TASKS) {
+		bisection->simulations++;
+		struct task_t *miss_task = simulate(ts);
+		if (miss_task == NULL) {
+			return 1;
+		}
+		int j = miss_task - ts->tasks;
+		*too_late |= 1 << j;
+		*too_early |= bisection->reordered_with[j];
+		return 0;
+	}
+
+	int low = 0;
+	int high = ts->tasks[i].period;
+	while (low <= high) {
+		int pcp = low + (high - low) / 2;
+		int late = 0, early = 0;
+		ts->tasks[i].phase_change_point = pcp;
+		if (bisect_phase_change_points(ts, i + 1, bisection, &late, &early)) {
+			return 1;
+		}
+		*too_late |= late;
+		*too_early |= early;
+
+		int is_late = (late >> i) & 1;
+		int is_early = (early >> i) & 1;
+		if (is_late && !is_early) {
+			high = pcp - 1;
+		} else if (is_early && !is_late) {
+			low = pcp + 1;
+		} else if (!is_late && !is_early) {
+			return 0; /* The misses do not depend on task i */
+		} else { /* Not monotone, scan the rest */
+			bisection->fallbacks++;
+			return scan_phase_change_points(ts, i, low, high, pcp, bisection,
+					too_late, too_early);
+		}
+	}
+	return 0;
+}
+
+/*
+ * Test the phase change points first..last of task i, except skip, each with
+ * a bisection of those of the tasks after i, like
+ * bisect_phase_change_points().
+ */
+int scan_phase_change_points(struct taskset_t *ts, int i, int first, int last,
+		int skip, struct bisection_t *bisection, int *too_late,
+		int *too_early) {
+	for (int pcp = first; pcp <= last; pcp++) {
+		if (pcp == skip) {
+			continue;
+		}
+		ts->tasks[i].phase_change_point = pcp;
+		if (bisect_phase_change_points(ts, i + 1, bisection, too_late,
+					too_early)) {
+			return 1;
+		}
+	}
+	return 0;
+}
+
+/*
+ * Test whether a schedulable combination of phase change points can be found
+ * by bisection with the current priorities (see the sweep command).
+ *
+ * Returns 1, with the phase change points set, if one is found, otherwise
+ * returns 0.
+ */
+int test_phase_change_points_bisected(struct taskset_t *ts) {
+	struct bisection_t bisection;
+	int too_late = 0, too_early = 0;
+	init_bisection(&bisection, ts);
+	return bisect_phase_change_points(ts, 0, &bisection, &too_late,
+			&too_early);
+}
+
+/*
+ * Same as test_all_phase_change_points(), but bisects the phase change points
+ * of T2..T4 for each one of T1 (-b option). The phase change points of T1 are
+ * still tested one at a time, so that the chunks can be split, stolen and
+ * checkpointed as usual. When resuming from a checkpoint, the bisection for
+ * the phase change point of T1 in the cursor starts over.
+ *
+ * Returns 1 if a schedulable combination is found, otherwise returns 0, which
+ * unlike for the other searches does not prove that there is none.
+ */
+int test_all_phase_change_points_bisected(struct taskset_t *ts,
+		struct cursor_t *cursor) {
+	struct bisection_t bisection;
+	int T1end; /* End of the chunk of phase change points of T1 */
+	int schedulable = 0;
+
+	if (options.output == OUTPUT_FULL) {
+		lock_output();
+		printf("Bisecting the phase change points of T2..T4 for each one of "
+				"T1...\n");
+		unlock_output();
+	}
+
+	init_bisection(&bisection, ts);
+	for (int T1pcp = advance_chunk(cursor, cursor->phase_change_point[0],
+				&T1end);
+			T1pcp < T1end; T1pcp = advance_chunk(cursor, T1pcp + 1, &T1end)) {
+		ts->tasks[0].phase_change_point = T1pcp;
+		ts->tasks[1].phase_change_point = 0;
+		ts->tasks[2].phase_change_point = 0;
+		if (search_is_stopped(cursor, ts)) {
+			break; /* Another worker found a valid setting. */
+		}
+
+		int too_late = 0, too_early = 0;
+		if (bisect_phase_change_points(ts, 1, &bisection, &too_late,
+					&too_early)) {
+			print_witness(ts);
+			schedulable = 1;
+			break;
+		}
+	}
+
+	pthread_mutex_lock(&search.lock);
+	search.simulated_combinations += bisection.simulations;
+	search.bisection_fallbacks += bisection.fallbacks;
+	pthread_mutex_unlock(&search.lock);
+	return schedulable;
+}
+
+/*
+ * ============================================================================
+ * OpenCL engine for whole grids of phase change points (-e gpu option, only
+ * with make OPENCL=1).
+ *
+ * For each phase change point of T1, all combinations of those of T2..T4 are
+ * simulated at once on the GPU, one work item per combination. The CPU
+ * engines stay the reference: any schedulable combination found on the GPU
+ * is simulated again with simulate_sas() before it is reported, and the
+ * selfcheck command compares the two on counterexample 3.
+ * ============================================================================
+ */
+
+#if OPENCL
+/*
+ * OpenCL C source of the kernel. Work item id simulates the SAS with the phase
+ * change point T1pcp of T1 and combination first + id of those of T2..T4, in
+ * the order of the nested loops in test_all_phase_change_points(). The task
+ * array holds the WCETs, periods, phase 1 and phase 2 priorities of the four
+ * tasks. The kernel follows simulate_sas(), but counts the age of the last job
+ * of each task instead of storing its release time. A schedulable combination
+ * lowers *witness to its index with atomic_min(), so the smallest schedulable
+ * index wins in whatever order the work items run. Work items whose index is
+ * larger than the witness give up.
+ */
+const char *gpu_kernel_source =
+	"__kernel void simulate_sas_grid(__constant int *task, int T1pcp,\n"
+	"		long hyper_period, uint first, uint count,\n"
+	"		volatile __global uint *witness) {\n"
+	"	uint id = first + (uint)get_global_id(0);\n"
+	"	int pcp[4], age[4], remaining[4];\n"
+	"	if (id - first >= count) {\n"
+	"		return;\n"
+	"	}\n"
+	"	uint rest = id;\n"
+	"	for (int i = 3; i > 0; i--) {\n"
+	"		pcp[i] = rest % (task[4 + i] + 1);\n"
+	"		rest /= task[4 + i] + 1;\n"
+	"	}\n"
+	"	pcp[0] = T1pcp;\n"
+	"	for (int i = 0; i < 4; i++) {\n"
+	"		age[i] = task[4 + i]; /* Releases at time 0 */\n"
+	"		remaining[i] = 0;\n"
+	"	}\n"
+	"	for (long t = 0; t <= hyper_period; t++) {\n"
+	"		if ((t & 4095) == 0 && *witness < id) {\n"
+	"			return; /* A smaller index is schedulable */\n"
+	"		}\n"
+	"		int hp = -1, hp_prio = 0;\n"
+	"		for (int i = 0; i < 4; i++) {\n"
+	"			if (age[i] >= task[4 + i]) {\n"
+	"				if (remaining[i] > 0) {\n"
+	"					return; /* Deadline miss */\n"
+	"				}\n"
+	"				age[i] = 0;\n"
+	"				remaining[i] = task[i];\n"
+	"			}\n"
+	"			int prio = age[i] < pcp[i] ? task[8 + i] : task[12 + i];\n"
+	"			if (remaining[i] > 0 && (hp < 0 || prio < hp_prio)) {\n"
+	"				hp = i;\n"
+	"				hp_prio = prio;\n"
+	"			}\n"
+	"		}\n"
+	"		if (hp >= 0) {\n"
+	"			remaining[hp]--;\n"
+	"		}\n"
+	"		for (int i = 0; i < 4; i++) {\n"
+	"			age[i]++;\n"
+	"		}\n"
+	"	}\n"
+	"	atomic_min(witness, id);\n"
+	"}\n";
+
+/*
+ * The OpenCL device and kernel, shared by all workers, which take turns on it.
+ */
+struct gpu_t {
+	pthread_mutex_t lock;
+	int initialized;
+	cl_command_queue queue;
+	cl_kernel kernel;
+	cl_mem task_buffer;    /* WCETs, periods and priorities of the tasks */
+	cl_mem witness_buffer; /* Smallest schedulable index of a launch */
+};
+
+struct gpu_t gpu = {PTHREAD_MUTEX_INITIALIZER, 0, NULL, NULL, NULL, NULL};
+
+/*
+ * Exit with an error message if an OpenCL call failed.
+ */
+void check_cl(cl_int error, const char *call) {
+	if (error != CL_SUCCESS) {
+		fprintf(stderr, "%s() failed with OpenCL error %d.\n", call, error);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * Set up the first GPU of the first OpenCL platform (or its first device of
+ * any type if it has no GPU) and build the kernel. Called with gpu.lock held.
+ */
+void init_gpu() {
+	cl_platform_id platform;
+	cl_device_id device;
+	cl_uint num_platforms = 0;
+	cl_int error;
+
+	if (clGetPlatformIDs(1, &platform, &num_platforms) != CL_SUCCESS ||
+			num_platforms == 0) {
+		fprintf(stderr, "No OpenCL platform found for the gpu engine.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (clGetDeviceIDs(platform, CL_DEVICE_TYPE_GPU, 1, &device, NULL) !=
+			CL_SUCCESS) {
+		check_cl(clGetDeviceIDs(platform, CL_DEVICE_TYPE_ALL, 1, &device,
+					NULL), "clGetDeviceIDs");
+	}
+	cl_context context = clCreateContext(NULL, 1, &device, NULL, NULL,
+			&error);
+	check_cl(error, "clCreateContext");
+	gpu.queue = clCreateCommandQueue(context, device, 0, &error);
+	check_cl(error, "clCreateCommandQueue");
+
+	cl_program program = clCreateProgramWithSource(context, 1,
+			&gpu_kernel_source, NULL, &error);
+	check_cl(error, "clCreateProgramWithSource");
+	if (clBuildProgram(program, 1, &device, NULL, NULL, NULL) != CL_SUCCESS) {
+		char log[4096] = "";
+		clGetProgramBuildInfo(program, device, CL_PROGRAM_BUILD_LOG,
+				sizeof(log) - 1, log, NULL);
+		fprintf(stderr, "Building the gpu kernel failed:\n%s\n", log);
+		exit(EXIT_FAILURE);
+	}
+	gpu.kernel = clCreateKernel(program, "simulate_sas_grid", &error);
+	check_cl(error, "clCreateKernel");
+
+	gpu.task_buffer = clCreateBuffer(context, CL_MEM_READ_ONLY,
+			4 * NUM_TASKS * sizeof(cl_int), NULL, &error);
+	check_cl(error, "clCreateBuffer");
+	gpu.witness_buffer = clCreateBuffer(context, CL_MEM_READ_WRITE,
+			sizeof(cl_uint), NULL, &error);
+	check_cl(error, "clCreateBuffer");
+	gpu.initialized = 1;
+}
+
+/*
+ * Simulate the SAS on the GPU for count combinations of phase change points
+ * with T1's as in the task set, starting at combination first of those of
+ * T2..T4 (see gpu_kernel_source).
+ *
+ * Returns the smallest schedulable index of a combination of T2..T4, or -1 if
+ * none of them is schedulable.
+ */
+long simulate_sas_gpu(struct taskset_t *ts, long first, long count) {
+	cl_int task[4 * NUM_TASKS];
+	for (int i = 0; i < NUM_TASKS; i++) {
+		task[i] = ts->tasks[i].wcet;
+		task[NUM_TASKS + i] = ts->tasks[i].period;
+		task[2 * NUM_TASKS + i] = ts->tasks[i].phase_1_prio;
+		task[3 * NUM_TASKS + i] = ts->tasks[i].phase_2_prio;
+	}
+	cl_int T1pcp = ts->tasks[0].phase_change_point;
+	cl_long hyper_period = ts->hyper_period;
+	cl_uint first_index = first;
+	cl_uint num = count;
+	cl_uint witness = CL_UINT_MAX; /* No schedulable index yet */
+	size_t global_size = count;
+
+	pthread_mutex_lock(&gpu.lock);
+	if (!gpu.initialized) {
+		init_gpu();
+	}
+	check_cl(clEnqueueWriteBuffer(gpu.queue, gpu.task_buffer, CL_TRUE, 0,
+				sizeof(task), task, 0, NULL, NULL), "clEnqueueWriteBuffer");
+	check_cl(clEnqueueWriteBuffer(gpu.queue, gpu.witness_buffer, CL_TRUE, 0,
+				sizeof(witness), &witness, 0, NULL, NULL),
+			"clEnqueueWriteBuffer");
+	check_cl(clSetKernelArg(gpu.kernel, 0, sizeof(cl_mem), &gpu.task_buffer),
+			"clSetKernelArg");
+	check_cl(clSetKernelArg(gpu.kernel, 1, sizeof(T1pcp), &T1pcp),
+			"clSetKernelArg");
+	check_cl(clSetKernelArg(gpu.kernel, 2, sizeof(hyper_period),
+				&hyper_period), "clSetKernelArg");
+	check_cl(clSetKernelArg(gpu.kernel, 3, sizeof(first_index), &first_index),
+			"clSetKernelArg");
+	check_cl(clSetKernelArg(gpu.kernel, 4, sizeof(num), &num),
+			"clSetKernelArg");
+	check_cl(clSetKernelArg(gpu.kernel, 5, sizeof(cl_mem),
+				&gpu.witness_buffer), "clSetKernelArg");
+	check_cl(clEnqueueNDRangeKernel(gpu.queue, gpu.kernel, 1, NULL,
+				&global_size, NULL, 0, NULL, NULL), "clEnqueueNDRangeKernel");
+	check_cl(clEnqueueReadBuffer(gpu.queue, gpu.witness_buffer, CL_TRUE, 0,
+				sizeof(witness), &witness, 0, NULL, NULL),
+			"clEnqueueReadBuffer");
+	pthread_mutex_unlock(&gpu.lock);
+
+	return witness == CL_UINT_MAX ? -1 : (long)witness;
+}
+
+/*
+ * Set the phase change points of T2..T4 of the task set to those of
+ * combination index of them, in the order of the nested loops in
+ * test_all_phase_change_points().
+ */
+void set_grid_phase_change_points(struct taskset_t *ts, long index) {
+	for (int i = NUM_TASKS - 1; i > 0; i--) {
+		ts->tasks[i].phase_change_point = index % (ts->tasks[i].period + 1);
+		index /= ts->tasks[i].period + 1;
+	}
+}
+
+/*
+ * Same as test_all_phase_change_points(), but simulates all combinations of
+ * phase change points of T2..T4 for each one of T1 at once on the GPU. Used
+ * with the gpu engine, which is not combined with -p, -f, -m or -s.
+ *
+ * The search stops and checkpoints only between phase change points of T1.
+ * When resuming from a checkpoint, the first launch starts at the phase change
+ * points of T2 and T3 in the cursor.
+ */
+int test_all_phase_change_points_gpu(struct taskset_t *ts,
+		struct cursor_t *cursor) {
+	const long total_combinations = count_combinations(ts);
+	const long grid = combinations_before_chunk_end(ts, 1); /* Per T1pcp */
+	long generated_combinations = combinations_before(ts, cursor);
+	long first = generated_combinations % grid; /* Start of the first grid */
+	int T1end; /* End of the chunk of phase change points of T1 */
+
+	assert(grid < CL_UINT_MAX);
+	if (options.output == OUTPUT_FULL) {
+		lock_output();
+		printf("Testing all %ld possible combinations of phase change points "
+				"in grids of %ld on the GPU...\n", total_combinations, grid);
+		unlock_output();
+	}
+
+	for (int T1pcp = advance_chunk(cursor, cursor->phase_change_point[0],
+				&T1end);
+			T1pcp < T1end; T1pcp = advance_chunk(cursor, T1pcp + 1, &T1end)) {
+		ts->tasks[0].phase_change_point = T1pcp;
+		set_grid_phase_change_points(ts, first);
+		if (search_is_stopped(cursor, ts)) {
+			return 0; /* Another worker found a valid setting. */
+		}
+
+		long index = simulate_sas_gpu(ts, first, grid - first);
+		COUNT_BATCHED_SIMULATIONS(ts, (index < 0 ? grid : index + 1) - first);
+		if (index >= 0) { /* SAS is schedulable */
+			set_grid_phase_change_points(ts, index);
+			if (simulate_sas(ts) != NULL) {
+				fprintf(stderr, "The gpu engine disagrees with simulate_sas() "
+						"on phase change points %d, %d, %d, %d.\n",
+						ts->tasks[0].phase_change_point,
+						ts->tasks[1].phase_change_point,
+						ts->tasks[2].phase_change_point,
+						ts->tasks[3].phase_change_point);
+				exit(EXIT_FAILURE);
+			}
+			print_witness(ts);
+			return 1; /* Return if a valid setting is found. */
+		}
+		generated_combinations += grid - first;
+		first = 0;
+	}
+	assert(generated_combinations == combinations_before_chunk_end(ts, T1end));
+	return 0; /* Not schedulable with any promotion points. */
+}
+#endif
+
+/*
+ * Store the current priorities of the task set in the permutation.
+ */
+void get_priorities(struct prio_permutation_t *perm, struct taskset_t *ts) {
+	for (int i = 0; i < NUM_TASKS; i++) {
+		perm->phase_1_prio[i] = ts->tasks[i].phase_1_prio;
+		perm->phase_2_prio[i] = ts->tasks[i].phase_2_prio;
+	}
+}
+
+/*
+ * Set the priorities of the task set according to the permutation.
+ */
+void set_priorities(struct taskset_t *ts, struct prio_permutation_t *perm) {
+	for (int i = 0; i < NUM_TASKS; i++) {
+		ts->tasks[i].phase_1_prio = perm->phase_1_prio[i];
+		ts->tasks[i].phase_2_prio = perm->phase_2_prio[i];
+	}
+}
+
+/*
+ * Get a key that is the same for two priority permutations of the task set if
+ * (but not only if) they give the same schedulability over all combinations of
+ * phase change points. Two such rules are used.
+ *
+ * (1) The phase 1 and phase 2 priorities of a task are never compared to each
+ *     other, as a task has at most one active job. If no other priority lies
+ *     between them (the values differ by 1), swapping them therefore changes
+ *     the outcome of no comparison, and gives exactly the same schedules. The
+ *     key always uses the order where phase 2 is the higher priority.
+ *
+ * (2) Tasks with the same WCET and period can trade priorities (along with
+ *     phase change points) without changing anything but the names of the
+ *     tasks. The key sorts the priorities of such tasks.
+ *
+ * Each priority value is stored in 3 bits of the key.
+ */
+long get_permutation_key(struct taskset_t *ts,
+		struct prio_permutation_t *perm) {
+	int p1[NUM_TASKS];
+	int p2[NUM_TASKS];
+	int temp;
+
+	for (int i = 0; i < NUM_TASKS; i++) {
+		p1[i] = perm->phase_1_prio[i];
+		p2[i] = perm->phase_2_prio[i];
+		if (p1[i] + 1 == p2[i]) { /* Rule (1) */
+			temp = p1[i];
+			p1[i] = p2[i];
+			p2[i] = temp;
+		}
+	}
+
+	int swapped = 1;
+	while (swapped) { /* Rule (2), naive sorting */
+		swapped = 0;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			for (int j = i + 1; j < NUM_TASKS; j++) {
+				if (ts->tasks[i].wcet == ts->tasks[j].wcet &&
+						ts->tasks[i].period == ts->tasks[j].period &&
+						p1[j] < p1[i]) {
+					temp = p1[i]; p1[i] = p1[j]; p1[j] = temp;
+					temp = p2[i]; p2[i] = p2[j]; p2[j] = temp;
+					swapped = 1;
+				}
+			}
+		}
+	}
+
+	long key = 0;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		key = (key << 6) | (p1[i] << 3) | p2[i];
+	}
+	return key;
+}
+
+/*
+ * Remove from the table all priority permutations with the same key (see
+ * get_permutation_key()) as an earlier permutation in the table, keeping the
+ * order of the others. Returns the number of permutations left.
+ */
+long remove_equivalent_permutations(struct taskset_t *ts,
+		struct prio_permutation_t *perms, long total_permutations) {
+	const long num_keys = 1L << (6 * NUM_TASKS);
+	unsigned char *seen = xmalloc(num_keys / 8);
+	memset(seen, 0, num_keys / 8);
+
+	long kept = 0;
+	for (long i = 0; i < total_permutations; i++) {
+		long key = get_permutation_key(ts, &perms[i]);
+		if (!(seen[key / 8] & (1 << (key % 8)))) {
+			seen[key / 8] |= 1 << (key % 8);
+			perms[kept] = perms[i];
+			kept++;
+		}
+	}
+
+	free(seen);
+	return kept;
+}
+
+/*
+ * With the -w option, let the worker with the given cursor take over the
+ * second half of the phase change points of T1 that another worker has left
+ * in its chunk, from the worker that has the most of them left.
+ *
+ * Precondition: search.lock is held.
+ */
+void steal_chunk(struct cursor_t *cursor) {
+	struct cursor_t *victim = NULL;
+	int most_left = 0;
+	for (int w = 0; w < options.num_threads; w++) {
+		struct cursor_t *other = &search.cursors[w];
+		int left = other->end - other->phase_change_point[0] - 1;
+		if (other->permutation >= 0 && left > most_left) {
+			victim = other;
+			most_left = left;
+		}
+	}
+	if (victim == NULL) {
+		return;
+	}
+
+	int middle = victim->end - (most_left + 1) / 2;
+	cursor->permutation = victim->permutation;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		cursor->phase_change_point[i] = 0;
+	}
+	cursor->phase_change_point[0] = middle;
+	cursor->end = victim->end;
+	victim->end = middle;
+	search.pending_chunks[cursor->permutation]++;
+
+	if (options.output == OUTPUT_FULL) {
+		lock_output();
+		printf("Took over phase change points %d to %d of T1 of priority "
+				"permutation %ld.\n\n",
+				middle,
+				cursor->end - 1,
+				cursor->permutation + 1);
+		unlock_output();
+	}
+}
+
+/*
+ * Hand out the next chunk to test by setting the cursor of a worker to it.
+ * Unfinished chunks from a checkpoint are handed out first, at the phase
+ * change points where they stopped. Then each permutation is handed out as a
+ * chunk with all phase change points of T1, and with the -w option, the
+ * chunks of other workers are split once no permutations are left. Returns
+ * the index of the permutation, or -1 if there is nothing left to hand out or
+ * if the search has been stopped.
+ */
+long take_next_chunk(struct cursor_t *cursor) {
+	pthread_mutex_lock(&search.lock);
+	cursor->permutation = -1;
+	if (!search.schedulable && search.num_resumed > 0) {
+		search.num_resumed--;
+		*cursor = search.resumed[search.num_resumed];
+	} else if (!search.schedulable &&
+			search.next_permutation < search.total_permutations) {
+		cursor->permutation = search.next_permutation;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			cursor->phase_change_point[i] = 0;
+		}
+		cursor->end = search.ts->tasks[0].period + 1;
+		search.pending_chunks[cursor->permutation] = 1;
+		search.next_permutation++;
+	} else if (!search.schedulable && options.steal) {
+		steal_chunk(cursor);
+	}
+	pthread_mutex_unlock(&search.lock);
+	return cursor->permutation;
+}
+
+/*
+ * Record that a chunk of permutation i has been tested without finding a
+ * schedulable configuration. Returns 1 if that was the last unfinished chunk
+ * of the permutation, otherwise 0.
+ */
+int finish_chunk(long i) {
+	pthread_mutex_lock(&search.lock);
+	search.pending_chunks[i]--;
+	int finished = search.pending_chunks[i] == 0;
+	if (finished) {
+		search.finished_permutations++;
+	}
+	pthread_mutex_unlock(&search.lock);
+	return finished;
+}
+
+/*
+ * Write a record for the finished priority permutation i to the JSON lines
+ * result stream (--json option), if there is one. The record gives the
+ * priorities, as i is only the position in this run's table, after -u and
+ * --shard. witness is the schedulable configuration, if the permutation is
+ * schedulable and its worker was the first to find one, or otherwise NULL. It
+ * is written as a record of its own after that of the permutation.
+ */
+void write_json_permutation(long i, int schedulable,
+		struct taskset_t *witness) {
+	if (search.json == NULL) {
+		return;
+	}
+	struct prio_permutation_t *perm = &search.perms[i];
+	lock_output();
+	fprintf(search.json, "{\"type\": \"permutation\", \"index\": %ld, ", i);
+	for (int j = 0; j < NUM_TASKS; j++) {
+		fprintf(search.json, "%s%d", j == 0 ? "\"phase_1_prio\": [" : ", ",
+				perm->phase_1_prio[j]);
+	}
+	for (int j = 0; j < NUM_TASKS; j++) {
+		fprintf(search.json, "%s%d", j == 0 ? "], \"phase_2_prio\": [" : ", ",
+				perm->phase_2_prio[j]);
+	}
+	fprintf(search.json, "], \"schedulable\": %s}\n",
+			schedulable ? "true" : "false");
+	if (witness != NULL) {
+		fprintf(search.json, "{\"type\": \"witness\", \"index\": %ld, "
+				"\"tasks\": [", i);
+		for (int j = 0; j < NUM_TASKS; j++) {
+			struct task_t *task = &witness->tasks[j];
+			fprintf(search.json, "%s{\"wcet\": %d, \"period\": %d, "
+					"\"phase_1_prio\": %d, \"phase_2_prio\": %d, "
+					"\"phase_change_point\": %d}",
+					j == 0 ? "" : ", ",
+					task->wcet,
+					task->period,
+					task->phase_1_prio,
+					task->phase_2_prio,
+					task->phase_change_point);
+		}
+		fprintf(search.json, "]}\n");
+	}
+	unlock_output();
+}
+
+#if INSTRUMENT
+/*
+ * Print the instrumentation counters to the stream, as a JSON object if json
+ * is set.
+ */
+void print_counters(FILE *stream, struct counters_t *counters, int json) {
+	if (json) {
+		fprintf(stream, "\"simulations\": %ld, \"batched_simulations\": %ld, "
+				"\"ticks\": %ld, \"misses_by_task\": [",
+				counters->simulations,
+				counters->batched_simulations,
+				counters->ticks);
+		for (int i = 0; i < NUM_TASKS; i++) {
+			fprintf(stream, "%s%ld", i == 0 ? "" : ", ",
+					counters->misses_by_task[i]);
+		}
+		fprintf(stream, "], \"misses_at_time\": [");
+		for (int b = 0; b < MISS_TIME_BUCKETS; b++) {
+			fprintf(stream, "%s%ld", b == 0 ? "" : ", ",
+					counters->misses_at_time[b]);
+		}
+		fprintf(stream, "]");
+		return;
+	}
+
+	fprintf(stream, "Counters: %ld simulations (and %ld batched), %ld ticks.\n",
+			counters->simulations,
+			counters->batched_simulations,
+			counters->ticks);
+	fprintf(stream, "First deadline misses by task:");
+	for (int i = 0; i < NUM_TASKS; i++) {
+		fprintf(stream, " T%d %ld", i + 1, counters->misses_by_task[i]);
+	}
+	fprintf(stream, "\nFirst deadline misses by time:\n");
+	for (int b = 0; b < MISS_TIME_BUCKETS; b++) {
+		if (counters->misses_at_time[b] > 0) {
+			fprintf(stream, "    [%ld, %ld): %ld\n",
+					b == 0 ? 0 : 1L << (b - 1),
+					1L << b,
+					counters->misses_at_time[b]);
+		}
+	}
+	fprintf(stream, "\n");
+}
+
+/*
+ * Report the instrumentation counters of the task set after testing priority
+ * permutation i, and add them to the sum of the search.
+ */
+void report_permutation_counters(long i, struct taskset_t *ts) {
+	struct counters_t *counters = &ts->counters;
+	pthread_mutex_lock(&search.lock);
+	search.counters.simulations += counters->simulations;
+	search.counters.batched_simulations += counters->batched_simulations;
+	search.counters.ticks += counters->ticks;
+	for (int j = 0; j < NUM_TASKS; j++) {
+		search.counters.misses_by_task[j] += counters->misses_by_task[j];
+	}
+	for (int b = 0; b < MISS_TIME_BUCKETS; b++) {
+		search.counters.misses_at_time[b] += counters->misses_at_time[b];
+	}
+	pthread_mutex_unlock(&search.lock);
+
+	lock_output();
+	if (options.output == OUTPUT_FULL) {
+		printf("Priority permutation %ld:\n", i + 1);
+		print_counters(stdout, counters, 0);
+	}
+	if (search.json != NULL) {
+		fprintf(search.json, "{\"type\": \"counters\", \"index\": %ld, ", i);
+		print_counters(search.json, counters, 1);
+		fprintf(search.json, "}\n");
+	}
+	unlock_output();
+}
+#endif
+
+/*
+ * Worker for the search over priority permutations. Repeatedly takes the next
+ * untested permutation and tests all combinations of phase change points with
+ * it, using its own copy of the task set in its worker context. Stops when
+ * there are no permutations left or when any worker has found a schedulable
+ * configuration.
+ */
+void *permutation_worker(void *arg) {
+	int w = *(int *)arg;
+	struct cursor_t *cursor = &search.cursors[w];
+	struct worker_t *worker = init_worker(&worker_arena, w, search.ts);
+	struct taskset_t *ts = &worker->ts;
+	long i;
+
+	while ((i = take_next_chunk(cursor)) >= 0) {
+		double start = get_seconds();
+		set_priorities(ts, &search.perms[i]);
+#if INSTRUMENT
+		memset(&ts->counters, 0, sizeof(ts->counters));
+#endif
+
+		if (options.output == OUTPUT_FULL &&
+				combinations_before(ts, cursor) == 0) {
+			lock_output();
+			printf("Generated priority permutation %ld of %ld...\n",
+					i + 1,
+					search.total_permutations);
+			print_taskset(ts, 1, 0);
+			unlock_output();
+		}
+
+		/*
+		 * Test all possible combinations of phase change points of the chunk
+		 * with these priorities by simulating the SAS.
+		 */
+		int schedulable;
+		if (options.bisect) {
+			schedulable = test_all_phase_change_points_bisected(ts, cursor);
+		} else if (options.prune) {
+			schedulable = test_all_phase_change_points_pruned(ts, cursor);
+		} else if (options.engine == ENGINE_SIMD) {
+			schedulable = test_all_phase_change_points_batched(ts, cursor);
+#if OPENCL
+		} else if (options.engine == ENGINE_GPU) {
+			schedulable = test_all_phase_change_points_gpu(ts, cursor);
+#endif
+		} else if (options.order != ORDER_UP) {
+			schedulable = test_all_phase_change_points_ordered(ts, cursor,
+					&worker->order);
+		} else {
+			schedulable = test_all_phase_change_points(ts, cursor);
+		}
+		worker->busy_seconds += get_seconds() - start;
+#if INSTRUMENT
+		report_permutation_counters(i, ts);
+#endif
+		if (schedulable) {
+			pthread_mutex_lock(&search.lock);
+			int first = !search.schedulable;
+			if (first) {
+				search.witness = *ts;
+			}
+			search.schedulable = 1; /* Make all other workers stop */
+			search.finished_permutations++;
+			pthread_mutex_unlock(&search.lock);
+			write_json_permutation(i, 1, first ? ts : NULL);
+			break;
+		}
+		if (search_is_stopped(cursor, ts)) { /* Cut short by another worker */
+			break;
+		}
+		if (!finish_chunk(i)) {
+			continue; /* Other chunks of the permutation are left */
+		}
+		write_json_permutation(i, 0, NULL);
+
+		if (options.output == OUTPUT_FULL) {
+			lock_output();
+			if (options.num_threads == 1) {
+				printf("Unschedulable for all combinations "
+					   "of phase change points.\n\n");
+			} else {
+				printf("Priority permutation %ld unschedulable for all "
+					   "combinations of phase change points.\n\n", i + 1);
+			}
+			unlock_output();
+		}
+	}
+	release_worker(worker);
+	return NULL;
+}
+
+/*
+ * Keep only the permutations of the shard given by the --shard option, i.e.,
+ * those whose index i in the table has i % options.num_shards ==
+ * options.shard, by moving them to the start of the table.
+ *
+ * Returns the number of permutations kept.
+ */
+long select_shard(struct prio_permutation_t *perms, long total_permutations) {
+	long kept = 0;
+	for (long i = options.shard; i < total_permutations;
+			i += options.num_shards) {
+		perms[kept] = perms[i];
+		kept++;
+	}
+	return kept;
+}
+
+/*
+ * Print the machine-readable result line of a shard, for merging the results
+ * of all shards of a distributed search:
+ *
+ *    RESULT shard=K/N permutations=X/Y schedulable=no
+ *    RESULT shard=K/N permutations=X/Y schedulable=yes witness=A,B,C:...
+ *
+ * where X is the number of permutations in the shard, Y the number in all
+ * shards together, and the witness gives the phase 1 priority, phase 2
+ * priority and phase change point of each task.
+ */
+void print_shard_result(long shard_permutations, long all_permutations) {
+	printf("RESULT shard=%d/%d permutations=%ld/%ld schedulable=%s",
+			options.shard,
+			options.num_shards,
+			shard_permutations,
+			all_permutations,
+			search.schedulable ? "yes" : "no");
+	if (search.schedulable) {
+		for (int i = 0; i < NUM_TASKS; i++) {
+			printf("%s%d,%d,%d",
+					i == 0 ? " witness=" : ":",
+					search.witness.tasks[i].phase_1_prio,
+					search.witness.tasks[i].phase_2_prio,
+					search.witness.tasks[i].phase_change_point);
+		}
+	}
+	printf("\n\n");
+}
+
+/*
+ * Print the share of the given time that each worker spent testing chunks,
+ * given the time of each worker in busy_seconds.
+ */
+void print_utilization(const double *busy_seconds, double seconds) {
+	printf("Worker utilization:");
+	for (int w = 0; w < options.num_threads; w++) {
+		printf(" %.1f%%", seconds > 0 ?
+				100 * busy_seconds[w] / seconds : 100.0);
+	}
+	printf("\n\n");
+}
+
+/*
+ * Test all given priority permutations of the task set, each with all possible
+ * combinations of phase change points. The permutations are handed out to
+ * options.num_threads workers (the calling thread only, if that is 1). With
+ * the -u option, equivalent permutations are first removed from the table.
+ * With --shard, only the permutations of one shard are then tested. With
+ * --checkpoint, the progress of the workers is saved periodically, and with
+ * --resume, the search continues from such a checkpoint.
+ *
+ * Returns 1 if any schedulable configuration exists, otherwise returns 0.
+ */
+int test_permutations(struct taskset_t *ts, struct prio_permutation_t *perms,
+		long total_permutations) {
+	if (options.unique) {
+		long all_permutations = total_permutations;
+		total_permutations = remove_equivalent_permutations(ts, perms,
+				all_permutations);
+		if (options.output >= OUTPUT_PROGRESS) {
+			printf("Symmetry reduction: %ld of %ld priority permutations are "
+					"equivalent to an earlier one, %ld left to test.\n\n",
+					all_permutations - total_permutations,
+					all_permutations,
+					total_permutations);
+		}
+	}
+	long all_permutations = total_permutations;
+	if (options.num_shards > 1) {
+		total_permutations = select_shard(perms, all_permutations);
+		if (options.output >= OUTPUT_PROGRESS) {
+			printf("Shard %d/%d: testing %ld of %ld priority permutations."
+					"\n\n",
+					options.shard,
+					options.num_shards,
+					total_permutations,
+					all_permutations);
+		}
+	}
+
+	search.ts = ts;
+	search.perms = perms;
+	search.total_permutations = total_permutations;
+	search.next_permutation = 0;
+	search.schedulable = 0;
+	search.simulated_combinations = 0;
+	search.skipped_combinations = 0;
+	search.bisection_fallbacks = 0;
+	memset(&search.prefilter_stats, 0, sizeof(search.prefilter_stats));
+	search.num_resumed = 0;
+	search.next_checkpoint_time = time(NULL) + options.checkpoint_interval;
+	search.pending_chunks = xmalloc(total_permutations * sizeof(int));
+	memset(search.pending_chunks, 0, total_permutations * sizeof(int));
+	search.finished_permutations = 0;
+	search.start_time = time(NULL);
+	search.next_progress_time = time(NULL) + options.progress_interval;
+#if INSTRUMENT
+	memset(&search.counters, 0, sizeof(search.counters));
+#endif
+	search.json = NULL;
+	if (options.json_file != NULL) {
+		search.json = fopen(options.json_file, "w");
+		if (search.json == NULL) {
+			perror("Could not open JSON result stream");
+			exit(EXIT_FAILURE);
+		}
+		setvbuf(search.json, NULL, _IOLBF, BUFSIZ);
+	}
+
+	int worker_ids[MAX_THREADS];
+	for (int i = 0; i < options.num_threads; i++) {
+		worker_ids[i] = i;
+		search.cursors[i].permutation = -1;
+	}
+	if (options.resume_file != NULL) {
+		read_checkpoint();
+	}
+
+	create_worker_arena(&worker_arena, options.num_threads, ts);
+	start_reporter();
+	double start = get_seconds();
+	if (options.num_threads == 1) {
+		permutation_worker(&worker_ids[0]);
+	} else {
+		pthread_t threads[MAX_THREADS];
+		for (int i = 0; i < options.num_threads; i++) {
+			if (pthread_create(&threads[i], NULL, permutation_worker,
+						&worker_ids[i])) {
+				fprintf(stderr, "Could not create worker thread.\n");
+				exit(EXIT_FAILURE);
+			}
+		}
+		for (int i = 0; i < options.num_threads; i++) {
+			pthread_join(threads[i], NULL);
+		}
+	}
+
+	double seconds = get_seconds() - start;
+	stop_reporter();
+	double busy_seconds[MAX_THREADS]; /* Read after the join, without a lock */
+	for (int w = 0; w < options.num_threads; w++) {
+		busy_seconds[w] = get_worker(&worker_arena, w)->busy_seconds;
+	}
+	destroy_worker_arena(&worker_arena);
+
+	/* All permutations must have been tested unless the search stopped. */
+	assert(search.schedulable ||
+			(search.next_permutation == total_permutations &&
+			 search.num_resumed == 0));
+	free(search.pending_chunks);
+	search.pending_chunks = NULL;
+
+	/* The search is finished, so there is nothing left to resume. */
+	if (options.checkpoint_file != NULL) {
+		remove(options.checkpoint_file);
+	}
+
+	if (options.prune && options.output >= OUTPUT_PROGRESS) {
+		printf("Pruning: simulated %ld and skipped %ld combinations of phase "
+				"change points in total.\n\n",
+				search.simulated_combinations,
+				search.skipped_combinations);
+	}
+	if (options.bisect && options.output >= OUTPUT_PROGRESS) {
+		printf("Bisection: simulated %ld combinations of phase change points "
+				"in total, with %ld linear scans.\n\n",
+				search.simulated_combinations,
+				search.bisection_fallbacks);
+	}
+	if (options.bisect && !search.schedulable) {
+		/* Printed at every output level, as the verdict depends on it */
+		printf("Bisection: not all combinations of phase change points were "
+				"tested, so this is no proof.\n\n");
+	}
+	if (any_prefilter_enabled() && options.output >= OUTPUT_PROGRESS) {
+		print_prefilter_statistics(&search.prefilter_stats);
+	}
+	if (options.num_threads > 1 && options.output >= OUTPUT_PROGRESS) {
+		print_utilization(busy_seconds, seconds);
+	}
+	if (options.num_shards > 1) {
+		print_shard_result(total_permutations, all_permutations);
+	}
+#if INSTRUMENT
+	if (options.output >= OUTPUT_PROGRESS) {
+		printf("Total over all tested priority permutations:\n");
+		print_counters(stdout, &search.counters, 0);
+	}
+#endif
+	if (search.json != NULL) {
+		fprintf(search.json, "{\"type\": \"result\", \"shard\": %d, "
+				"\"num_shards\": %d, \"permutations\": %ld, "
+				"\"all_permutations\": %ld, \"finished_permutations\": %ld, "
+				"\"seconds\": %ld, \"schedulable\": %s}\n",
+				options.shard,
+				options.num_shards,
+				total_permutations,
+				all_permutations,
+				search.finished_permutations,
+				(long)(time(NULL) - search.start_time),
+				search.schedulable ? "true" : "false");
+		fclose(search.json);
+		search.json = NULL;
+	}
+	return search.schedulable;
+}
+
+/*
+ * Generate all 8! = 40320 permutations of the 8 priority values (each task has
+ * 2 priorities) into perms, in lexicographic order of (T1p2, T2p2, T3p2, T4p2,
+ * T1p1, T2p1, T3p1, T4p1). The priorities of the task set are overwritten.
+ *
+ * Returns the number of generated permutations.
+ *
+ * Precondition: The task set has four tasks and perms has room for all
+ *               permutations.
+ */
+long generate_all_permutations(struct taskset_t *ts,
+		struct prio_permutation_t *perms) {
+	const long total_permutations = 8*7*6*5*4*3*2*1; /* 8! = 40320 */
+	long generated_permutations = 0;
+
+	/*
+	 * Naively generate all permutations of priorities.
+	 * T1p2 becomes the phase 2 priority of task T1 etc.
+	 */
+	for (int T1p2 = 0; T1p2 < 8; T1p2++) {
+		ts->tasks[0].phase_2_prio = T1p2;
+
+		for (int T2p2 = 0; T2p2 < 8; T2p2++) {
+			if (T2p2 == T1p2) continue;
+			ts->tasks[1].phase_2_prio = T2p2;
+
+			for (int T3p2 = 0; T3p2 < 8; T3p2++) {
+				if (T3p2 == T1p2) continue;
+				if (T3p2 == T2p2) continue;
+				ts->tasks[2].phase_2_prio = T3p2;
+
+				for (int T4p2 = 0; T4p2 < 8; T4p2++) {
+					if (T4p2 == T1p2) continue;
+					if (T4p2 == T2p2) continue;
+					if (T4p2 == T3p2) continue;
+					ts->tasks[3].phase_2_prio = T4p2;
+
+					for (int T1p1 = 0; T1p1 < 8; T1p1++) {
+						if (T1p1 == T1p2) continue;
+						if (T1p1 == T2p2) continue;
+						if (T1p1 == T3p2) continue;
+						if (T1p1 == T4p2) continue;
+						ts->tasks[0].phase_1_prio = T1p1;
+
+						for (int T2p1 = 0; T2p1 < 8; T2p1++) {
+							if (T2p1 == T1p2) continue;
+							if (T2p1 == T2p2) continue;
+							if (T2p1 == T3p2) continue;
+							if (T2p1 == T4p2) continue;
+							if (T2p1 == T1p1) continue;
+							ts->tasks[1].phase_1_prio = T2p1;
+
+							for (int T3p1 = 0; T3p1 < 8; T3p1++) {
+								if (T3p1 == T1p2) continue;
+								if (T3p1 == T2p2) continue;
+								if (T3p1 == T3p2) continue;
+								if (T3p1 == T4p2) continue;
+								if (T3p1 == T1p1) continue;
+								if (T3p1 == T2p1) continue;
+								ts->tasks[2].phase_1_prio = T3p1;
+
+								for (int T4p1 = 0; T4p1 < 8; T4p1++) {
+									if (T4p1 == T1p2) continue;
+									if (T4p1 == T2p2) continue;
+									if (T4p1 == T3p2) continue;
+									if (T4p1 == T4p2) continue;
+									if (T4p1 == T1p1) continue;
+									if (T4p1 == T2p1) continue;
+									if (T4p1 == T3p1) continue;
+									ts->tasks[3].phase_1_prio = T4p1;
+									
+									get_priorities(
+										&perms[generated_permutations], ts);
+									generated_permutations++;
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	assert(generated_permutations == total_permutations);
+	return total_permutations;
+}
+
+/*
+ * Test dual priority schedulability exhaustively by simulating the SAS for
+ * all possible configurations of priorities and phase change points.
+ *
+ * Returns 1 if there exists a schedulable configuration, otherwise returns 0.
+ *
+ * Precondition: The task set has four tasks.
+ *
+ * There are 8! = 40320 possible permutations of the 8 priority values
+ * (each task has 2 priorities). These will all be generated.
+ *
+ * The permutations are first all generated into a table by
+ * generate_all_permutations(). Then, for each priority permutation,
+ * test_all_phase_change_points() is called (by test_permutations(), possibly
+ * from several worker threads) to simulate the SAS with all possible settings
+ * of the phase change points.
+ */
+int test_all_configurations_exhaustively(struct taskset_t *ts) {
+	struct prio_permutation_t *perms =
+		xmalloc(MAX_PERMUTATIONS * sizeof(struct prio_permutation_t));
+	long total_permutations = generate_all_permutations(ts, perms);
+
+	/*
+	 * Test all possible combinations of phase change points with each of the
+	 * generated priority permutations by simulating the SAS.
+	 */
+	int schedulable = test_permutations(ts, perms, total_permutations);
+	free(perms);
+	if (schedulable) {
+		return 1; /* Return if schedulable */
+	}
+
+	/* Not schedulable with any priority permutation */
+	if (options.bisect) {
+		printf("No schedulable configuration found by the bisection.\n");
+		return 0;
+	}
+	if (options.num_shards > 1) {
+		printf("Task set is not dual-priority schedulable with the "
+				"permutations of this shard.\n");
+		return 0;
+	}
+	printf("Task set is not dual-priority schedulable!\n");
+	return 0; 
+}
+
+/*
+ * Generate all binomial(8, 4) * 4! = 8! / 4! = 1680 permutations of the 8
+ * priority values where the phase 1 priorities are Rate Monotonic into perms.
+ * The priorities of the task set are overwritten.
+ *
+ * Returns the number of generated permutations.
+ *
+ * Precondition: The task set has four tasks sorted in Rate Monotonic order and
+ *               perms has room for all permutations.
+ */
+long generate_rm_permutations(struct taskset_t *ts,
+		struct prio_permutation_t *perms) {
+	const long total_permutations = 8*7*6*5; /* 8!/4! = 1680 */
+	long generated_permutations = 0;
+
+	/*
+	 * Naively generate all permutations of priorities, where the phase 1
+	 * priorities are Rate Monotonic.
+	 * T1p2 becomes the phase 2 priority of task T1 etc.
+	 */
+	for (int T1p1 = 0; T1p1 < 8; T1p1++) {
+		ts->tasks[0].phase_1_prio = T1p1;
+
+		for (int T2p1 = T1p1 + 1; T2p1 < 8; T2p1++) {
+			ts->tasks[1].phase_1_prio = T2p1;
+
+			for (int T3p1 = T2p1 + 1; T3p1 < 8; T3p1++) {
+				ts->tasks[2].phase_1_prio = T3p1;
+
+				for (int T4p1 = T3p1 + 1; T4p1 < 8; T4p1++) {
+					ts->tasks[3].phase_1_prio = T4p1;
+
+					for (int T1p2 = 0; T1p2 < 8; T1p2++) {
+						if (T1p2 == T1p1) continue;
+						if (T1p2 == T2p1) continue;
+						if (T1p2 == T3p1) continue;
+						if (T1p2 == T4p1) continue;
+						ts->tasks[0].phase_2_prio = T1p2;
+
+						for (int T2p2 = 0; T2p2 < 8; T2p2++) {
+							if (T2p2 == T1p1) continue;
+							if (T2p2 == T2p1) continue;
+							if (T2p2 == T3p1) continue;
+							if (T2p2 == T4p1) continue;
+							if (T2p2 == T1p2) continue;
+							ts->tasks[1].phase_2_prio = T2p2;
+
+							for (int T3p2 = 0; T3p2 < 8; T3p2++) {
+								if (T3p2 == T1p1) continue;
+								if (T3p2 == T2p1) continue;
+								if (T3p2 == T3p1) continue;
+								if (T3p2 == T4p1) continue;
+								if (T3p2 == T1p2) continue;
+								if (T3p2 == T2p2) continue;
+								ts->tasks[2].phase_2_prio = T3p2;
+
+								for (int T4p2 = 0; T4p2 < 8; T4p2++) {
+									if (T4p2 == T1p1) continue;
+									if (T4p2 == T2p1) continue;
+									if (T4p2 == T3p1) continue;
+									if (T4p2 == T4p1) continue;
+									if (T4p2 == T1p2) continue;
+									if (T4p2 == T2p2) continue;
+									if (T4p2 == T3p2) continue;
+									ts->tasks[3].phase_2_prio = T4p2;
+									
+									get_priorities(
+										&perms[generated_permutations], ts);
+									generated_permutations++;
+								}
+							}
+						}
+					}
+				}
+			}
+		}
+	}
+	assert(generated_permutations == total_permutations);
+	return total_permutations;
+}
+
+/*
+ * Test dual priority schedulability exhaustively by simulating the SAS for
+ * all possible configurations of priorities and phase change points, under the
+ * restriction that the phase 1 priorities of the tasks are Rate Monotonic.
+ *
+ * Returns 1 if there is such a schedulable configuration, otherwise returns 0.
+ *
+ * Precondition: The task set has four tasks sorted in Rate Monotonic order.
+ *
+ * There are binomial(8, 4) * 4! = 8! / 4! = 1680 possible priority
+ * permutations here. These will all be generated.
+ *
+ * The permutations are first all generated into a table by
+ * generate_rm_permutations(). Then, for each priority permutation,
+ * test_all_phase_change_points() is called (by test_permutations(), possibly
+ * from several worker threads) to simulate the SAS with all possible settings
+ * of the phase change points.
+ */
+int test_rm_configurations_exhaustively(struct taskset_t *ts) {
+	struct prio_permutation_t *perms =
+		xmalloc(MAX_PERMUTATIONS * sizeof(struct prio_permutation_t));
+	long total_permutations = generate_rm_permutations(ts, perms);
+
+	/*
+	 * Test all possible combinations of phase change points with each of the
+	 * generated priority permutations by simulating the SAS.
+	 */
+	int schedulable = test_permutations(ts, perms, total_permutations);
+	free(perms);
+	if (schedulable) {
+		return 1; /* Return if schedulable */
+	}
+
+	/* Not schedulable with any priority permutation */
+	if (options.bisect) {
+		printf("No schedulable configuration with RM for phase 1 found by the "
+				"bisection.\n");
+		return 0;
+	}
+	if (options.num_shards > 1) {
+		printf("Task set is not dual-priority schedulable with RM for phase 1 "
+				"with the permutations of this shard.\n");
+		return 0;
+	}
+	printf("Task set is not dual-priority schedulable with RM for phase 1!\n");
+	return 0; 
+}
+
+/*
+ * ============================================================================
+ * Generic exhaustive search for task sets with GEN_TASKS tasks.
+ *
+ * Unlike the naive functions above, this search is not hard coded for four
+ * tasks. Priority permutations are generated by a lexicographic
+ * next-permutation iterator and combinations of phase change points by an
+ * odometer, in the same order as the nested loops above. GEN_TASKS is a
+ * compile-time parameter (e.g., make GEN_TASKS=5), so that all loops over the
+ * tasks in the simulation have a constant bound.
+ *
+ * For GEN_TASKS = 4, the "selfcheck" command checks this search against the
+ * naive one.
+ * ============================================================================
+ */
+
+struct gen_taskset_t {
+	int wcet[GEN_TASKS];
+	int period[GEN_TASKS];
+	int phase_1_prio[GEN_TASKS];
+	int phase_2_prio[GEN_TASKS];
+	int phase_change_point[GEN_TASKS];
+	long hyper_period;
+};
+
+/*
+ * Print the task set with its priorities and phase change points.
+ */
+void print_gen_taskset(struct gen_taskset_t *ts) {
+	for (int i = 0; i < GEN_TASKS; i++) {
+		printf("T%d (%2d, %3d): phase 1 prio = %d, phase 2 prio = %d, "
+				"phase change point = %d\n",
+				i+1,
+				ts->wcet[i],
+				ts->period[i],
+				ts->phase_1_prio[i],
+				ts->phase_2_prio[i],
+				ts->phase_change_point[i]);
+	}
+}
+
+/*
+ * Rearrange the n values in a into the lexicographically next permutation.
+ * Returns 0 (leaving a in sorted order) if a was the last permutation,
+ * otherwise returns 1.
+ */
+int next_permutation(int *a, int n) {
+	int i = n - 2;
+	int j = n - 1;
+	int temp;
+	while (i >= 0 && a[i] >= a[i + 1]) { /* Find the last ascent a[i] < a[i+1] */
+		i--;
+	}
+	if (i >= 0) {
+		while (a[j] <= a[i]) { /* Find the last value above a[i] */
+			j--;
+		}
+		temp = a[i]; a[i] = a[j]; a[j] = temp;
+	}
+	for (int l = i + 1, r = n - 1; l < r; l++, r--) { /* Reverse the suffix */
+		temp = a[l]; a[l] = a[r]; a[r] = temp;
+	}
+	return i >= 0;
+}
+
+/*
+ * Advance the odometer of n digits, where digit i ranges from 0 to max[i] and
+ * the last digit turns fastest. Returns 0 (leaving all digits 0) if all values
+ * have been generated, otherwise returns 1.
+ */
+int next_odometer(int *digits, const int *max, int n) {
+	for (int i = n - 1; i >= 0; i--) {
+		if (digits[i] < max[i]) {
+			digits[i]++;
+			return 1;
+		}
+		digits[i] = 0;
+	}
+	return 0;
+}
+
+/*
+ * Simulate the SAS up to the hyper-period or the first deadline miss, in the
+ * same way as simulate_sas(). Returns the index of the first task to miss a
+ * deadline, or -1 if all deadlines are met.
+ */
+int simulate_sas_gen(struct gen_taskset_t *ts) {
+	long last_release_time[GEN_TASKS];
+	int remaining_wcet[GEN_TASKS];
+	for (int i = 0; i < GEN_TASKS; i++) {
+		last_release_time[i] = -1; /* -1 means never released */
+		remaining_wcet[i] = -1;
+	}
+
+	for (long t = 0; t <= ts->hyper_period; t++) {
+
+		/* Check for deadline misses. */
+		for (int i = 0; i < GEN_TASKS; i++) {
+			if (remaining_wcet[i] > 0 &&
+					t - last_release_time[i] >= ts->period[i]) {
+				return i; /* Return on first deadline miss. */
+			}
+		}
+
+		/* Release new jobs from all ready tasks. */
+		for (int i = 0; i < GEN_TASKS; i++) {
+			if (last_release_time[i] < 0 ||
+					t - last_release_time[i] >= ts->period[i]) {
+				last_release_time[i] = t;
+				remaining_wcet[i] = ts->wcet[i];
+			}
+		}
+
+		/* Execute the highest-priority task. */
+		int hp_task = -1;
+		int highest_prio = -1;
+		for (int i = 0; i < GEN_TASKS; i++) {
+			if (remaining_wcet[i] > 0) {
+				int prio = t - last_release_time[i] <
+					ts->phase_change_point[i] ?
+					ts->phase_1_prio[i] : ts->phase_2_prio[i];
+				if (prio < highest_prio || highest_prio < 0) {
+					highest_prio = prio;
+					hp_task = i;
+				}
+			}
+		}
+		if (hp_task >= 0) {
+			remaining_wcet[hp_task]--;
+		}
+	}
+
+	return -1; /* No deadline misses in the SAS. */
+}
+
+/*
+ * Same as test_all_phase_change_points(), for GEN_TASKS tasks, using an
+ * odometer over the phase change points (the last task turns fastest).
+ */
+int test_all_phase_change_points_gen(struct gen_taskset_t *ts) {
+	long total_combinations = 1;
+	long generated_combinations = 0;
+	for (int i = 0; i < GEN_TASKS; i++) {
+		total_combinations = saturating_mul(total_combinations,
+				ts->period[i] + 1L);
+		ts->phase_change_point[i] = 0;
+	}
+
+	if (options.output == OUTPUT_FULL) {
+		printf("Testing all %ld possible combinations of phase change "
+				"points...\n", total_combinations);
+	}
+
+	do {
+		generated_combinations++;
+		if (simulate_sas_gen(ts) < 0) { /* SAS is schedulable */
+			if (options.output >= OUTPUT_PROGRESS) {
+				printf("Schedulable with this configuration:\n\n");
+				print_gen_taskset(ts);
+			}
+			return 1; /* Return if a valid setting is found. */
+		}
+	} while (next_odometer(ts->phase_change_point, ts->period, GEN_TASKS));
+
+	assert(generated_combinations == total_combinations);
+	return 0; /* Not schedulable with any promotion points. */
+}
+
+/*
+ * Set the priorities of the task set from prios, which holds the phase 2
+ * priorities of all tasks followed by their phase 1 priorities. This is the
+ * order of the nested loops in generate_all_permutations().
+ */
+void set_gen_priorities(struct gen_taskset_t *ts, const int *prios) {
+	for (int i = 0; i < GEN_TASKS; i++) {
+		ts->phase_2_prio[i] = prios[i];
+		ts->phase_1_prio[i] = prios[GEN_TASKS + i];
+	}
+}
+
+/*
+ * Same as test_all_configurations_exhaustively(), for GEN_TASKS tasks. All
+ * (2 * GEN_TASKS)! priority permutations are generated by next_permutation().
+ *
+ * Returns 1 if there exists a schedulable configuration, otherwise returns 0.
+ */
+int test_all_configurations_gen(struct gen_taskset_t *ts) {
+	int prios[2 * GEN_TASKS];
+	long total_permutations = 1;
+	long generated_permutations = 0;
+	for (int i = 0; i < 2 * GEN_TASKS; i++) {
+		prios[i] = i;
+		total_permutations *= i + 1;
+	}
+
+	do {
+		set_gen_priorities(ts, prios);
+		generated_permutations++;
+
+		if (options.output == OUTPUT_FULL) {
+			printf("Generated priority permutation %ld of %ld...\n",
+					generated_permutations,
+					total_permutations);
+		}
+
+		if (test_all_phase_change_points_gen(ts)) {
+			return 1; /* Return if schedulable */
+		}
+		if (options.output == OUTPUT_FULL) {
+			printf("Unschedulable for all combinations "
+				   "of phase change points.\n\n");
+		}
+	} while (next_permutation(prios, 2 * GEN_TASKS));
+
+	/* Not schedulable with any priority permutation */
+	assert(generated_permutations == total_permutations);
+	printf("Task set is not dual-priority schedulable!\n");
+	return 0;
+}
+
+/*
+ * Read a task set of GEN_TASKS tasks from the arguments, each given as
+ * WCET,PERIOD. Exits the program on malformed input.
+ */
+void parse_gen_taskset(struct gen_taskset_t *ts, char **args, int num_args) {
+	if (num_args != GEN_TASKS) {
+		fprintf(stderr, "Expected %d tasks (set with make GEN_TASKS=N).\n",
+				GEN_TASKS);
+		exit(EXIT_FAILURE);
+	}
+	ts->hyper_period = 1;
+	for (int i = 0; i < GEN_TASKS; i++) {
+		if (sscanf(args[i], "%d,%d", &ts->wcet[i], &ts->period[i]) != 2 ||
+				ts->wcet[i] < 1 || ts->wcet[i] > ts->period[i]) {
+			fprintf(stderr, "Malformed task: %s\n", args[i]);
+			exit(EXIT_FAILURE);
+		}
+		ts->hyper_period = lcm(ts->hyper_period, ts->period[i]);
+	}
+}
+
+/*
+ * Exhaustively test the task set given on the command line with the generic
+ * search.
+ */
+void run_generic_search(char **args, int num_args) {
+	struct gen_taskset_t ts;
+	parse_gen_taskset(&ts, args, num_args);
+	exit_if_beyond_horizon(ts.hyper_period);
+	long combinations = 1;
+	for (int i = 0; i < GEN_TASKS; i++) {
+		combinations = saturating_mul(combinations, ts.period[i] + 1L);
+	}
+	if (combinations == LONG_MAX) {
+		fprintf(stderr, "Too many combinations of phase change points.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	printf("Exhaustively testing all configurations of %d tasks...\n\n",
+			GEN_TASKS);
+	if (test_all_configurations_gen(&ts)) {
+		printf("\nTask set is dual-priority schedulable.\n");
+	}
+}
+
+#if OPENCL
+/*
+ * Check that the gpu engine finds the same first schedulable combination of
+ * phase change points as test_all_phase_change_points() with simulate_sas()
+ * on counterexample 3, for the RM+RM priorities and for some pseudo-random
+ * priority permutations. Returns the number of permutations compared.
+ */
+long check_gpu_engine() {
+	struct taskset_t ts;
+	int W[NUM_TASKS] = {6, 6, 4, 5};
+	int P[NUM_TASKS] = {11, 20, 46, 74};
+	const int num_checks = 20;
+	enum output_t saved_output = options.output;
+	enum engine_t saved_engine = options.engine;
+
+	printf("Checking the gpu engine against simulate_sas()...\n");
+	for (int i = 0; i < NUM_TASKS; i++) {
+		ts.tasks[i].wcet = W[i];
+		ts.tasks[i].period = P[i];
+	}
+	ts.hyper_period = hyper_period(&ts);
+	struct prio_permutation_t *perms =
+		xmalloc(MAX_PERMUTATIONS * sizeof(struct prio_permutation_t));
+	long total_permutations = generate_all_permutations(&ts, perms);
+
+	options.output = OUTPUT_SILENT;
+	options.engine = ENGINE_TICK;
+	srand(4);
+	for (int k = 0; k < num_checks; k++) {
+		if (k == 0) { /* RM+RM, which is schedulable */
+			for (int i = 0; i < NUM_TASKS; i++) {
+				ts.tasks[i].phase_1_prio = NUM_TASKS + i;
+				ts.tasks[i].phase_2_prio = i;
+			}
+		} else {
+			set_priorities(&ts, &perms[rand() % total_permutations]);
+		}
+		struct taskset_t cpu_ts = ts;
+		struct cursor_t cpu_cursor = {0, {0}, P[0] + 1};
+		struct cursor_t gpu_cursor = {0, {0}, P[0] + 1};
+		int cpu_schedulable = test_all_phase_change_points(&cpu_ts,
+				&cpu_cursor);
+		int gpu_schedulable = test_all_phase_change_points_gpu(&ts,
+				&gpu_cursor);
+		int same = cpu_schedulable == gpu_schedulable;
+		for (int i = 0; i < NUM_TASKS && same && cpu_schedulable; i++) {
+			same = cpu_ts.tasks[i].phase_change_point ==
+				ts.tasks[i].phase_change_point;
+		}
+		if (!same) {
+			printf("Selfcheck failed: the gpu engine differs from "
+					"simulate_sas().\n");
+			print_taskset(&cpu_ts, 1, 0);
+			exit(EXIT_FAILURE);
+		}
+	}
+	options.output = saved_output;
+	options.engine = saved_engine;
+	free(perms);
+	return num_checks;
+}
+#endif
+
+/*
+ * Check simulate_sas_batch() (simd engine) against simulate_sas() on batches of
+ * pseudo-random phase change points of T4 for small task sets (periods 3 to 16,
+ * utilization at most 1), so that many lanes are schedulable: the first lane
+ * that the batch reports schedulable must be the first lane in which
+ * simulate_sas() meets all deadlines. Exits the program with failure on the
+ * first batch that differs.
+ *
+ * Returns the number of lanes simulated by simulate_sas().
+ */
+long check_batch_engine() {
+	struct taskset_t ts;
+	struct compact_taskset_t cts;
+	uint8_t last_pcp[BATCH_LANES];
+	long simulated = 0;
+	srand(6);
+	for (int s = 0; s < 300; s++) {
+		double utilization;
+		do {
+			utilization = 0;
+			for (int i = 0; i < NUM_TASKS; i++) {
+				ts.tasks[i].period = 3 + rand() % 14;
+				ts.tasks[i].wcet = 1 + rand() % ts.tasks[i].period;
+				utilization += (double)ts.tasks[i].wcet / ts.tasks[i].period;
+			}
+		} while (utilization > 1);
+		ts.hyper_period = hyper_period(&ts);
+
+		for (int b = 0; b < 20; b++) {
+			int prios[2 * NUM_TASKS];
+			for (int k = 0; k < 2 * NUM_TASKS; k++) { /* Random permutation */
+				int j = rand() % (k + 1);
+				prios[k] = prios[j];
+				prios[j] = k;
+			}
+			for (int i = 0; i < NUM_TASKS; i++) {
+				ts.tasks[i].phase_1_prio = prios[i];
+				ts.tasks[i].phase_2_prio = prios[NUM_TASKS + i];
+				ts.tasks[i].phase_change_point =
+					rand() % (ts.tasks[i].period + 1);
+			}
+			compact_taskset(&cts, &ts);
+			int num_lanes = 1 + rand() % BATCH_LANES;
+			int expected = -1;
+			for (int l = 0; l < num_lanes; l++) {
+				last_pcp[l] = rand() % (ts.tasks[NUM_TASKS - 1].period + 1);
+				ts.tasks[NUM_TASKS - 1].phase_change_point = last_pcp[l];
+				if (expected < 0 && simulate_sas(&ts) == NULL) {
+					expected = l;
+				}
+				simulated++;
+			}
+			if (simulate_sas_batch(&cts, last_pcp, num_lanes) != expected) {
+				printf("Selfcheck failed: batch simulation differs.\n");
+				print_taskset(&ts, 1, 1);
+				exit(EXIT_FAILURE);
+			}
+		}
+	}
+	return simulated;
+}
+
+/*
+ * Check each prefilter against simulate_sas() on pseudo-random configurations
+ * of small task sets (periods 3 to 16, utilization at most 1): every
+ * combination that a prefilter rejects must miss a deadline. Exits the program
+ * with failure on the first combination rejected wrongly.
+ *
+ * Returns the number of rejected combinations that were simulated.
+ */
+long check_prefilters() {
+	struct taskset_t ts;
+	long simulated = 0;
+	srand(5);
+	for (int s = 0; s < 300; s++) {
+		double utilization;
+		do {
+			utilization = 0;
+			for (int i = 0; i < NUM_TASKS; i++) {
+				ts.tasks[i].period = 3 + rand() % 14;
+				ts.tasks[i].wcet = 1 + rand() % ts.tasks[i].period;
+				utilization += (double)ts.tasks[i].wcet / ts.tasks[i].period;
+			}
+		} while (utilization > 1);
+		ts.hyper_period = hyper_period(&ts);
+
+		for (int c = 0; c < 3000; c++) {
+			int prios[2 * NUM_TASKS];
+			for (int k = 0; k < 2 * NUM_TASKS; k++) { /* Random permutation */
+				int j = rand() % (k + 1);
+				prios[k] = prios[j];
+				prios[j] = k;
+			}
+			int highest[NUM_TASKS], lowest[NUM_TASKS];
+			for (int i = 0; i < NUM_TASKS; i++) {
+				ts.tasks[i].phase_1_prio = prios[i];
+				ts.tasks[i].phase_2_prio = prios[NUM_TASKS + i];
+				ts.tasks[i].phase_change_point =
+					rand() % (ts.tasks[i].period + 1);
+				get_priority_range(&ts.tasks[i], &highest[i], &lowest[i]);
+			}
+			int misses = -1; /* Not simulated yet */
+			for (int k = 0; k < NUM_PREFILTERS; k++) {
+				if (!prefilters[k](&ts, highest, lowest)) {
+					continue;
+				}
+				if (misses < 0) {
+					misses = simulate_sas(&ts) != NULL;
+					simulated++;
+				}
+				if (!misses) {
+					printf("Selfcheck failed: prefilter %s rejects a "
+							"schedulable combination.\n", prefilter_names[k]);
+					print_taskset(&ts, 1, 1);
+					exit(EXIT_FAILURE);
+				}
+			}
+		}
+	}
+	return simulated;
+}
+
+/*
+ * Check that the memo prefilter (-m option) gives different cache keys to all
+ * subsets of up to NUM_TASKS - 1 tasks, also to subsets of equal size with the
+ * same priorities and phase change points, such as {T1, T2} and {T1, T3}.
+ * Exits the program with failure if two keys are equal.
+ */
+void check_memo_keys() {
+	struct taskset_t ts;
+	memset(&ts, 0, sizeof(ts));
+	uint64_t keys[1 << NUM_TASKS];
+	for (int i = 0; i < NUM_TASKS; i++) {
+		ts.tasks[i].phase_1_prio = NUM_TASKS + i;
+		ts.tasks[i].phase_2_prio = i;
+		ts.tasks[i].phase_change_point = 5;
+	}
+	for (int ordered = 0; ordered < 2; ordered++) {
+		if (ordered) { /* All tasks with the same relative priorities */
+			for (int i = 0; i < NUM_TASKS; i++) {
+				ts.tasks[i].phase_1_prio = ts.tasks[i].phase_2_prio = 0;
+			}
+		}
+		for (int mask = 1; mask < 1 << NUM_TASKS; mask++) {
+			int in_subset[NUM_TASKS], size = 0;
+			for (int i = 0; i < NUM_TASKS; i++) {
+				in_subset[i] = mask >> i & 1;
+				size += in_subset[i];
+			}
+			keys[mask] = size < NUM_TASKS ? get_memo_key(&ts, in_subset) : 0;
+			for (int other = 1; other < mask && size < NUM_TASKS; other++) {
+				if (keys[other] == keys[mask]) {
+					printf("Selfcheck failed: memo keys of task subsets %d "
+							"and %d are equal.\n", other, mask);
+					exit(EXIT_FAILURE);
+				}
+			}
+		}
+	}
+}
+
+/*
+ * Check the generic search against the naive one for four tasks: the priority
+ * permutations and the combinations of phase change points must be generated
+ * in the same order, and the simulations must agree. Exits the program with
+ * failure on the first difference.
+ */
+void run_selfcheck() {
+#if GEN_TASKS == NUM_TASKS
+	struct taskset_t ts;
+	struct gen_taskset_t gts;
+	int W[3][NUM_TASKS] = {{8, 13, 9, 14}, {13, 17, 4, 28}, {6, 6, 4, 5}};
+	int P[3][NUM_TASKS] = {{19, 29, 151, 197}, {29, 47, 89, 193},
+		{11, 20, 46, 74}};
+	long checked = 0;
+
+	printf("Checking the generic search against the naive search...\n");
+	for (int c = 0; c < 3; c++) { /* The three counterexamples */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			ts.tasks[i].wcet = gts.wcet[i] = W[c][i];
+			ts.tasks[i].period = gts.period[i] = P[c][i];
+		}
+		ts.hyper_period = gts.hyper_period = hyper_period(&ts);
+
+		/* Same permutations in the same order. */
+		struct prio_permutation_t *perms =
+			xmalloc(MAX_PERMUTATIONS * sizeof(struct prio_permutation_t));
+		long total_permutations = generate_all_permutations(&ts, perms);
+		int prios[2 * NUM_TASKS];
+		for (int i = 0; i < 2 * NUM_TASKS; i++) {
+			prios[i] = i;
+		}
+		for (long p = 0; p < total_permutations; p++) {
+			set_gen_priorities(&gts, prios);
+			for (int i = 0; i < NUM_TASKS; i++) {
+				if (gts.phase_1_prio[i] != perms[p].phase_1_prio[i] ||
+						gts.phase_2_prio[i] != perms[p].phase_2_prio[i]) {
+					printf("Selfcheck failed: permutation %ld differs.\n", p);
+					exit(EXIT_FAILURE);
+				}
+			}
+			int more = next_permutation(prios, 2 * NUM_TASKS);
+			assert(more == (p + 1 < total_permutations));
+		}
+
+		/* Same combinations of phase change points in the same order. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			gts.phase_change_point[i] = 0;
+		}
+		for (int T1pcp = 0; T1pcp <= P[c][0]; T1pcp++) {
+			for (int T2pcp = 0; T2pcp <= P[c][1]; T2pcp++) {
+				for (int T3pcp = 0; T3pcp <= P[c][2]; T3pcp++) {
+					for (int T4pcp = 0; T4pcp <= P[c][3]; T4pcp++) {
+						if (gts.phase_change_point[0] != T1pcp ||
+								gts.phase_change_point[1] != T2pcp ||
+								gts.phase_change_point[2] != T3pcp ||
+								gts.phase_change_point[3] != T4pcp) {
+							printf("Selfcheck failed: phase change points "
+									"differ.\n");
+							exit(EXIT_FAILURE);
+						}
+						next_odometer(gts.phase_change_point, gts.period,
+								GEN_TASKS);
+					}
+				}
+			}
+		}
+
+		/* Same first deadline miss for pseudo-random configurations. */
+		srand(c + 1);
+		for (int k = 0; k < 100000; k++) {
+			long p = rand() % total_permutations;
+			set_priorities(&ts, &perms[p]);
+			for (int i = 0; i < NUM_TASKS; i++) {
+				gts.phase_1_prio[i] = perms[p].phase_1_prio[i];
+				gts.phase_2_prio[i] = perms[p].phase_2_prio[i];
+				gts.phase_change_point[i] = ts.tasks[i].phase_change_point =
+					rand() % (P[c][i] + 1);
+			}
+			struct task_t *miss = simulate_sas(&ts);
+			int miss_task = simulate_sas_gen(&gts);
+			if ((miss == NULL ? -1 : miss - ts.tasks) != miss_task) {
+				printf("Selfcheck failed: simulations differ.\n");
+				exit(EXIT_FAILURE);
+			}
+			checked++;
+			if (simulate_countdown(&ts) != miss) {
+				printf("Selfcheck failed: countdown simulation differs.\n");
+				exit(EXIT_FAILURE);
+			}
+			checked++;
+			if (simulate_sas_event_driven(&ts) != miss) {
+				printf("Selfcheck failed: event simulation differs.\n");
+				exit(EXIT_FAILURE);
+			}
+			checked++;
+			if (simulate_sas_table(&ts) != miss) {
+				printf("Selfcheck failed: table simulation differs.\n");
+				exit(EXIT_FAILURE);
+			}
+			checked++;
+			if (simulate_compact(&ts) != miss) {
+				printf("Selfcheck failed: compact simulation differs.\n");
+				exit(EXIT_FAILURE);
+			}
+			checked++;
+#if SPECIALIZE
+			if (find_specialized_simulator(&ts)->simulate(&ts) != miss) {
+				printf("Selfcheck failed: specialized simulation differs.\n");
+				exit(EXIT_FAILURE);
+			}
+			checked++;
+#endif
+		}
+		free(perms);
+	}
+
+	/* The schedulable configurations of tests 2 and 3 (full hyper-period). */
+	int witnesses[2][3][NUM_TASKS] = {
+		{{13, 17, 4, 28}, {29, 47, 89, 193}, {13, 17, 42, 139}},
+		{{6, 6, 4, 5}, {11, 20, 46, 74}, {5, 3, 25, 35}}};
+	int witness_prios[2][2][NUM_TASKS] = {
+		{{4, 5, 7, 6}, {0, 1, 2, 3}},
+		{{4, 5, 6, 7}, {0, 1, 2, 3}}};
+	for (int w = 0; w < 2; w++) {
+		for (int i = 0; i < NUM_TASKS; i++) {
+			gts.wcet[i] = witnesses[w][0][i];
+			gts.period[i] = witnesses[w][1][i];
+			gts.phase_change_point[i] = witnesses[w][2][i];
+			gts.phase_1_prio[i] = witness_prios[w][0][i];
+			gts.phase_2_prio[i] = witness_prios[w][1][i];
+		}
+		gts.hyper_period = 1;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			gts.hyper_period = lcm(gts.hyper_period, gts.period[i]);
+		}
+		if (simulate_sas_gen(&gts) != -1) {
+			printf("Selfcheck failed: witness of test %d not schedulable.\n",
+					w + 2);
+			exit(EXIT_FAILURE);
+		}
+		checked++;
+	}
+	check_memo_keys();
+	checked += check_prefilters();
+	checked += check_batch_engine();
+#if OPENCL
+	checked += check_gpu_engine();
+#endif
+	printf("Selfcheck passed (%ld simulations compared).\n", checked);
+#else
+	printf("Selfcheck needs GEN_TASKS = %d (compiled with %d).\n",
+			NUM_TASKS, GEN_TASKS);
+	exit(EXIT_FAILURE);
+#endif
+}
+
+/*
+ * ============================================================================
+ * Batch sweep over task sets read from a file ("sweep" command).
+ *
+ * Each input line holds a task set of four tasks, each given as WCET,PERIOD
+ * and separated by whitespace. Empty lines and lines starting with '#' are
+ * skipped. A file is memory-mapped, standard input is read line by line. The
+ * task sets are processed in batches of SWEEP_BATCH sets by options.num_threads
+ * workers, and one verdict line is printed per task set, in input order.
+ * ============================================================================
+ */
+
+#define SWEEP_BATCH 4096   /* Task sets read before they are tested */
+#define SWEEP_LINE_MAX 256 /* Longest accepted input line */
+
+/*
+ * One task set of the sweep with its verdicts.
+ */
+struct sweep_set_t {
+	struct taskset_t ts;
+	int rm_schedulable;   /* Fixed-priority RM schedulable */
+	int fdms_schedulable; /* RM+RM schedulable with FDMS phase change points */
+	int bisect_schedulable; /* Or with bisected ones (-b option) */
+	int beyond_horizon;   /* Not tested, see is_within_horizon() */
+};
+
+/*
+ * Source of input lines, either a memory-mapped file (data != NULL) or a
+ * stream.
+ */
+struct sweep_input_t {
+	const char *data;
+	size_t size;
+	size_t pos;
+	FILE *stream;
+	long line_number;
+};
+
+/*
+ * State shared by the workers of one batch.
+ * All fields after the lock may only be accessed while holding it.
+ */
+struct sweep_t {
+	struct sweep_set_t *sets;
+	long num_sets;
+	pthread_mutex_t lock;
+	long next_set; /* Index of the next task set to hand out */
+};
+
+struct sweep_t sweep = {NULL, 0, PTHREAD_MUTEX_INITIALIZER, 0};
+
+/*
+ * Read the next input line into line, without the line terminator.
+ *
+ * Returns 1 if a line was read, or 0 at the end of the input. Exits the
+ * program if the line is longer than SWEEP_LINE_MAX - 1 characters.
+ */
+int read_sweep_line(struct sweep_input_t *in, char *line) {
+	size_t length = 0;
+	int c;
+	while (1) {
+		if (in->data != NULL) {
+			c = in->pos < in->size ? (unsigned char)in->data[in->pos++] : EOF;
+		} else {
+			c = getc(in->stream);
+		}
+		if (c == EOF && length == 0) {
+			return 0;
+		}
+		if (c == EOF || c == '\n') {
+			break;
+		}
+		if (length == SWEEP_LINE_MAX - 1) {
+			fprintf(stderr, "Line %ld is too long.\n", in->line_number + 1);
+			exit(EXIT_FAILURE);
+		}
+		line[length] = c;
+		length++;
+	}
+	if (length > 0 && line[length - 1] == '\r') {
+		length--;
+	}
+	line[length] = '\0';
+	in->line_number++;
+	return 1;
+}
+
+/*
+ * Parse a task set from an input line into ts, with the tasks sorted in Rate
+ * Monotonic order and RM+RM priorities set.
+ *
+ * Returns 1 if the line holds a task set, or 0 if it is empty or a comment.
+ * Exits the program on malformed input.
+ */
+int parse_sweep_taskset(struct taskset_t *ts, const char *line,
+		long line_number) {
+	int skipped = 0;
+	sscanf(line, " %n", &skipped);
+	if (line[skipped] == '\0' || line[skipped] == '#') {
+		return 0;
+	}
+
+	memset(ts, 0, sizeof(*ts));
+	const char *p = line;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		int wcet, period, length;
+		if (sscanf(p, " %d,%d%n", &wcet, &period, &length) != 2 ||
+				wcet < 1 || wcet > period) {
+			fprintf(stderr, "Malformed task set on line %ld: %s\n",
+					line_number, line);
+			exit(EXIT_FAILURE);
+		}
+		p += length;
+
+		/* Insert the task in RM order, after those with equal periods. */
+		int j = i;
+		while (j > 0 && ts->tasks[j - 1].period > period) {
+			ts->tasks[j] = ts->tasks[j - 1];
+			j--;
+		}
+		ts->tasks[j].wcet = wcet;
+		ts->tasks[j].period = period;
+	}
+	sscanf(p, " %n", &skipped);
+	if (p[skipped] != '\0') {
+		fprintf(stderr, "Malformed task set on line %ld: %s\n",
+				line_number, line);
+		exit(EXIT_FAILURE);
+	}
+
+	for (int i = 0; i < NUM_TASKS; i++) {
+		ts->tasks[i].phase_1_prio = NUM_TASKS + i;
+		ts->tasks[i].phase_2_prio = i;
+	}
+	ts->hyper_period = hyper_period(ts);
+	return 1;
+}
+
+/*
+ * Test a task set of the sweep, first with fixed-priority RM scheduling (all
+ * phase change points at the periods) and then with the FDMS policy. As FDMS
+ * starts from the fixed-priority RM configuration, it only needs to run if
+ * that misses a deadline. With the -b option, the phase change points are
+ * then bisected if FDMS also fails. The simulations run on the copy ts of the
+ * task set in the context of the worker, and only the verdicts are stored in
+ * the set.
+ */
+void test_sweep_set(struct sweep_set_t *set, struct taskset_t *ts) {
+	set->beyond_horizon = !is_within_horizon(set->ts.hyper_period);
+	if (set->beyond_horizon) {
+		set->rm_schedulable = 0;
+		set->fdms_schedulable = 0;
+		set->bisect_schedulable = 0;
+		return;
+	}
+	*ts = set->ts;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		ts->tasks[i].phase_change_point = ts->tasks[i].period;
+	}
+	set->rm_schedulable = simulate(ts) == NULL;
+	set->fdms_schedulable = set->rm_schedulable ||
+		test_fdms_phase_change_points(ts);
+	set->bisect_schedulable = set->fdms_schedulable ||
+		(options.bisect && test_phase_change_points_bisected(ts));
+}
+
+/*
+ * Test task sets of the current batch until all have been handed out. The
+ * argument points to the index of the worker.
+ */
+void *sweep_worker(void *arg) {
+	struct worker_t *worker = init_worker(&worker_arena, *(int *)arg, NULL);
+	while (1) {
+		pthread_mutex_lock(&sweep.lock);
+		long i = sweep.next_set;
+		sweep.next_set++;
+		pthread_mutex_unlock(&sweep.lock);
+		if (i >= sweep.num_sets) {
+			break;
+		}
+		test_sweep_set(&sweep.sets[i], &worker->ts);
+	}
+	release_worker(worker);
+	return NULL;
+}
+
+/*
+ * Test all task sets of the current batch with options.num_threads workers.
+ */
+void test_sweep_batch() {
+	int worker_ids[MAX_THREADS];
+	sweep.next_set = 0;
+	for (int i = 0; i < options.num_threads; i++) {
+		worker_ids[i] = i;
+	}
+	if (options.num_threads == 1) {
+		sweep_worker(&worker_ids[0]);
+		return;
+	}
+	pthread_t threads[MAX_THREADS];
+	for (int i = 0; i < options.num_threads; i++) {
+		if (pthread_create(&threads[i], NULL, sweep_worker,
+					&worker_ids[i])) {
+			fprintf(stderr, "Could not create worker thread.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (int i = 0; i < options.num_threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+}
+
+/*
+ * Print the verdict line of a tested task set of the sweep.
+ */
+void print_sweep_verdict(struct sweep_set_t *set) {
+	for (int i = 0; i < NUM_TASKS; i++) {
+		printf("%d,%d ", set->ts.tasks[i].wcet, set->ts.tasks[i].period);
+	}
+	if (set->beyond_horizon) {
+		printf("rm=skipped fdms=skipped%s\n",
+				options.bisect ? " bisect=skipped" : "");
+		return;
+	}
+	printf("rm=%s fdms=%s",
+			set->rm_schedulable ? "yes" : "no",
+			set->fdms_schedulable ? "yes" : "no");
+	if (options.bisect) {
+		printf(" bisect=%s", set->bisect_schedulable ? "yes" : "no");
+	}
+	printf("\n");
+}
+
+/*
+ * Test all task sets in the file given in the arguments (or on standard input
+ * if there is none, or it is "-") and print a verdict line for each of them.
+ */
+void run_sweep(char **args, int num_args) {
+	struct sweep_input_t in = {NULL, 0, 0, stdin, 0};
+	int fd = -1;
+	if (num_args > 1) {
+		fprintf(stderr, "Expected at most one task set file.\n");
+		exit(EXIT_FAILURE);
+	}
+	if (num_args == 1 && strcmp(args[0], "-") != 0) {
+		struct stat st;
+		fd = open(args[0], O_RDONLY);
+		if (fd < 0 || fstat(fd, &st) != 0) {
+			perror("Could not open task set file");
+			exit(EXIT_FAILURE);
+		}
+		in.size = st.st_size;
+		if (!S_ISREG(st.st_mode)) { /* E.g., a pipe, which cannot be mapped */
+			in.stream = fdopen(fd, "r");
+			if (in.stream == NULL) {
+				perror("Could not open task set file");
+				exit(EXIT_FAILURE);
+			}
+			fd = -1;
+		} else if (in.size > 0) {
+			void *data = mmap(NULL, in.size, PROT_READ, MAP_PRIVATE, fd, 0);
+			if (data == MAP_FAILED) {
+				perror("Could not map task set file");
+				exit(EXIT_FAILURE);
+			}
+			posix_madvise(data, in.size, POSIX_MADV_SEQUENTIAL);
+			in.data = data;
+		} else {
+			in.data = "";
+		}
+	}
+
+	sweep.sets = xmalloc(SWEEP_BATCH * sizeof(struct sweep_set_t));
+	create_worker_arena(&worker_arena, options.num_threads, NULL);
+	char line[SWEEP_LINE_MAX];
+	long total_sets = 0, rm_schedulable = 0, fdms_schedulable = 0;
+	long bisect_schedulable = 0, beyond_horizon = 0;
+	int more = 1;
+	while (more) {
+		sweep.num_sets = 0;
+		while (sweep.num_sets < SWEEP_BATCH &&
+				(more = read_sweep_line(&in, line))) {
+			if (parse_sweep_taskset(&sweep.sets[sweep.num_sets].ts, line,
+						in.line_number)) {
+				sweep.num_sets++;
+			}
+		}
+		test_sweep_batch();
+		for (long i = 0; i < sweep.num_sets; i++) {
+			print_sweep_verdict(&sweep.sets[i]);
+			rm_schedulable += sweep.sets[i].rm_schedulable;
+			fdms_schedulable += sweep.sets[i].fdms_schedulable;
+			bisect_schedulable += sweep.sets[i].bisect_schedulable;
+			beyond_horizon += sweep.sets[i].beyond_horizon;
+		}
+		total_sets += sweep.num_sets;
+	}
+	free(sweep.sets);
+	destroy_worker_arena(&worker_arena);
+	if (in.data != NULL && in.size > 0) {
+		munmap((void *)in.data, in.size);
+	}
+	if (fd >= 0) {
+		close(fd);
+	} else if (in.stream != stdin) {
+		fclose(in.stream);
+	}
+
+	if (options.output >= OUTPUT_PROGRESS) {
+		fprintf(stderr, "Swept %ld task sets: %ld schedulable with RM, %ld "
+				"with FDMS", total_sets, rm_schedulable, fdms_schedulable);
+		if (options.bisect) {
+			fprintf(stderr, ", %ld with FDMS or bisection",
+					bisect_schedulable);
+		}
+		if (beyond_horizon > 0) {
+			fprintf(stderr, ", %ld skipped for their hyper-period",
+					beyond_horizon);
+		}
+		fprintf(stderr, ".\n");
+	}
+}
+
+/*
+ * ============================================================================
+ * Schedule traces of the SAS ("trace" and "decode" commands).
+ *
+ * The trace command simulates one configuration of a task set with
+ * simulate_sas() while recording its scheduling events, and writes them to a
+ * binary file: a header with the configuration and the extent of the trace,
+ * followed by the records of the ring buffer from the oldest to the newest.
+ * The file is in the byte order of the machine that wrote it. The decode
+ * command prints such a file as text, or as a CSV file of the intervals in
+ * which each task runs, for plotting a Gantt chart.
+ * ============================================================================
+ */
+
+#define TRACE_MAGIC "DPTRACE1"
+
+struct trace_header_t {
+	char magic[8];                      /* TRACE_MAGIC */
+	int32_t wcet[NUM_TASKS];
+	int32_t period[NUM_TASKS];
+	int32_t phase_1_prio[NUM_TASKS];
+	int32_t phase_2_prio[NUM_TASKS];
+	int32_t phase_change_point[NUM_TASKS];
+	int32_t miss_task;                  /* -1 if no task missed */
+	int32_t reserved;
+	int64_t hyper_period;
+	int64_t first_time;                 /* Time the first delta is from */
+	int64_t end_time;                   /* End of the simulation */
+	int64_t records;
+	int64_t dropped;                    /* Records dropped at the start */
+	int64_t size;                       /* Bytes of records after this */
+};
+
+const char *trace_event_names[] = {"release", "promotion", "dispatch",
+	"preemption", "completion", "idle", "miss"};
+
+/*
+ * Parse a task as WCET,PERIOD,PHASE_1_PRIO,PHASE_2_PRIO,PHASE_CHANGE_POINT.
+ */
+void parse_trace_task(struct task_t *task, const char *arg) {
+	char end;
+	if (sscanf(arg, "%d,%d,%d,%d,%d%c", &task->wcet, &task->period,
+				&task->phase_1_prio, &task->phase_2_prio,
+				&task->phase_change_point, &end) != 5 ||
+			task->wcet < 1 || task->wcet > task->period ||
+			task->phase_change_point < 0 ||
+			task->phase_change_point > task->period) {
+		fprintf(stderr, "Malformed task: %s\n", arg);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * Write the trace of the simulation of the task set to the file at path.
+ */
+void write_trace(const char *path, struct taskset_t *ts) {
+	struct trace_header_t header;
+	memset(&header, 0, sizeof(header));
+	memcpy(header.magic, TRACE_MAGIC, sizeof(header.magic));
+	for (int i = 0; i < NUM_TASKS; i++) {
+		header.wcet[i] = ts->tasks[i].wcet;
+		header.period[i] = ts->tasks[i].period;
+		header.phase_1_prio[i] = ts->tasks[i].phase_1_prio;
+		header.phase_2_prio[i] = ts->tasks[i].phase_2_prio;
+		header.phase_change_point[i] = ts->tasks[i].phase_change_point;
+	}
+	header.miss_task = trace.miss_task;
+	header.hyper_period = ts->hyper_period;
+	header.first_time = trace.first_time;
+	header.end_time = trace.end_time;
+	header.records = trace.records;
+	header.dropped = trace.dropped;
+	header.size = trace.used;
+
+	FILE *f = fopen(path, "wb");
+	if (f == NULL) {
+		perror("Could not write trace");
+		exit(EXIT_FAILURE);
+	}
+	/* Write the ring buffer as the part up to its end and the wrapped part. */
+	size_t first_part = trace.capacity - trace.tail;
+	if (first_part > trace.used) {
+		first_part = trace.used;
+	}
+	if (fwrite(&header, sizeof(header), 1, f) != 1 ||
+			fwrite(trace.buffer + trace.tail, 1, first_part, f) !=
+				first_part ||
+			fwrite(trace.buffer, 1, trace.used - first_part, f) !=
+				trace.used - first_part ||
+			fclose(f) != 0) {
+		perror("Could not write trace");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * Simulate a configuration of a task set given as FILE and four tasks (see
+ * parse_trace_task()) while recording a trace to FILE.
+ */
+void run_trace(char **args, int num_args) {
+	if (num_args != NUM_TASKS + 1) {
+		fprintf(stderr, "Expected a trace file and %d tasks as "
+				"W,P,PRIO1,PRIO2,PCP.\n", NUM_TASKS);
+		exit(EXIT_FAILURE);
+	}
+	struct taskset_t ts;
+	memset(&ts, 0, sizeof(ts));
+	for (int i = 0; i < NUM_TASKS; i++) {
+		parse_trace_task(&ts.tasks[i], args[i + 1]);
+	}
+	ts.hyper_period = hyper_period(&ts);
+	exit_if_beyond_horizon(ts.hyper_period);
+
+	trace.capacity = (size_t)options.trace_buffer_size << 20;
+	trace.buffer = xmalloc(trace.capacity);
+	options.trace = 1;
+	struct timespec start, end;
+	clock_gettime(CLOCK_MONOTONIC, &start);
+	simulate_sas(&ts);
+	clock_gettime(CLOCK_MONOTONIC, &end);
+	options.trace = 0;
+	write_trace(args[0], &ts);
+	free(trace.buffer);
+	trace.buffer = NULL;
+
+	double elapsed = (end.tv_sec - start.tv_sec) +
+		(end.tv_nsec - start.tv_nsec) / 1e9;
+	if (trace.miss_task >= 0) {
+		printf("T%d missed its deadline at %ld", trace.miss_task + 1,
+				trace.end_time);
+	} else {
+		printf("No deadline miss up to the hyper-period %ld",
+				ts.hyper_period);
+	}
+	printf(" (simulated in %.2f s).\nWrote %ld records (%zu bytes) from time "
+			"%ld to %s", elapsed, trace.records, trace.used,
+			trace.first_time, args[0]);
+	if (trace.dropped > 0) {
+		printf(", after dropping the oldest %ld (see --trace-buffer)",
+				trace.dropped);
+	}
+	printf(".\n");
+}
+
+/*
+ * Print a trace file written by run_trace() as text (one event per line) or
+ * as a Gantt chart (one CSV row per interval that a task runs, and one per
+ * release, promotion, preemption and miss).
+ */
+void run_decode(char **args, int num_args) {
+	int gantt = 0;
+	if (num_args == 2 && strcmp(args[1], "gantt") == 0) {
+		gantt = 1;
+	} else if (num_args != 1 &&
+			!(num_args == 2 && strcmp(args[1], "text") == 0)) {
+		fprintf(stderr, "Expected a trace file and optionally text or "
+				"gantt.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	struct trace_header_t header;
+	FILE *f = fopen(args[0], "rb");
+	if (f == NULL) {
+		perror("Could not read trace");
+		exit(EXIT_FAILURE);
+	}
+	if (fread(&header, sizeof(header), 1, f) != 1 ||
+			memcmp(header.magic, TRACE_MAGIC, sizeof(header.magic)) != 0 ||
+			header.size < 0) {
+		fprintf(stderr, "Not a trace file: %s\n", args[0]);
+		exit(EXIT_FAILURE);
+	}
+	uint8_t *records = xmalloc(header.size + 1);
+	if (fread(records, 1, header.size, f) != (size_t)header.size) {
+		fprintf(stderr, "Truncated trace file: %s\n", args[0]);
+		exit(EXIT_FAILURE);
+	}
+	fclose(f);
+
+	if (gantt) {
+		printf("task,start,end,event\n");
+	} else {
+		for (int i = 0; i < NUM_TASKS; i++) {
+			printf("# T%d = (%d, %d), priorities %d/%d, phase change point "
+					"%d\n", i + 1, header.wcet[i], header.period[i],
+					header.phase_1_prio[i], header.phase_2_prio[i],
+					header.phase_change_point[i]);
+		}
+		printf("# Hyper-period %ld, %ld records from time %ld to %ld (%ld "
+				"dropped)\n", (long)header.hyper_period, (long)header.records,
+				(long)header.first_time, (long)header.end_time,
+				(long)header.dropped);
+	}
+
+	long t = header.first_time;
+	int running = -1;
+	long running_since = 0;
+	size_t pos = 0;
+	while (pos < (size_t)header.size) {
+		uint64_t value;
+		pos += read_trace_record(records, header.size, pos, &value);
+		t += value >> (TRACE_EVENT_BITS + TRACE_TASK_BITS);
+		int event = (value >> TRACE_TASK_BITS) & ((1 << TRACE_EVENT_BITS) - 1);
+		int task = value & ((1 << TRACE_TASK_BITS) - 1);
+		if (event > TRACE_MISS) {
+			fprintf(stderr, "Corrupt trace file: %s\n", args[0]);
+			exit(EXIT_FAILURE);
+		}
+
+		if (!gantt) {
+			if (event == TRACE_IDLE) {
+				printf("%ld\t-\t%s\n", t, trace_event_names[event]);
+			} else {
+				printf("%ld\tT%d\t%s\n", t, task + 1,
+						trace_event_names[event]);
+			}
+			continue;
+		}
+		/* A run ends when the task completes or another one starts. */
+		if (running >= 0 && (event == TRACE_COMPLETION ||
+					event == TRACE_PREEMPTION ||
+					event == TRACE_DISPATCH || event == TRACE_IDLE)) {
+			if (t > running_since) {
+				printf("T%d,%ld,%ld,run\n", running + 1, running_since, t);
+			}
+			running = -1;
+		}
+		if (event == TRACE_DISPATCH) {
+			running = task;
+			running_since = t;
+		} else if (event != TRACE_COMPLETION && event != TRACE_IDLE) {
+			printf("T%d,%ld,%ld,%s\n", task + 1, t, t,
+					trace_event_names[event]);
+		}
+	}
+	if (gantt && running >= 0 && header.end_time > running_since) {
+		printf("T%d,%ld,%ld,run\n", running + 1, running_since,
+				(long)header.end_time);
+	}
+	free(records);
+}
+
+/*
+ * ============================================================================
+ * Certificates of schedulable configurations ("certify" and "recheck"
+ * commands).
+ *
+ * The certify command splits the hyper-period of a configuration into
+ * CERTIFY_SEGMENTS segments and simulates them all twice, concurrently on two
+ * threads: once one time point at a time, like simulate_sas(), and once from
+ * event to event, like simulate_sas_event_driven(). For each segment, both
+ * simulations record the state of the SAS at its start (a snapshot) and a
+ * hash of its schedule, i.e., of the time points at which another task (or
+ * none) starts to run. Both modes are one loop, simulate_sas_segment(), and
+ * share the task selection, release and deadline checks, so they are not
+ * independent of each other. Each thread therefore also runs the unmodified
+ * engine that the tests use, simulate_sas() or simulate_sas_event_driven(),
+ * on the whole hyper-period. The configuration is certified if all four
+ * simulations meet all deadlines and the two segmented ones agree on every
+ * snapshot and hash. The snapshots and hashes are then written to a
+ * certificate file.
+ *
+ * The recheck command reads a certificate and simulates some segments again,
+ * chosen at random, in parallel (-j option). Each segment starts from its
+ * snapshot, and must end in the snapshot of the next segment with the same
+ * hash. Every segment can be checked on its own. Checking all of them again
+ * replays the whole hyper-period, as the certify command does. Checking a few
+ * of them gives a quick spot check of a certificate from elsewhere.
+ * ============================================================================
+ */
+
+#define CERTIFY_SEGMENTS 256
+#define SCHEDULE_HASH_BASIS 0xcbf29ce484222325ULL /* Those of 64-bit FNV-1a */
+#define SCHEDULE_HASH_PRIME 0x100000001b3ULL
+
+struct certificate_t {
+	struct taskset_t ts;
+	int event_driven;          /* Simulate from event to event */
+	long num_segments;
+	struct snapshot_t *starts; /* State at the start of each segment */
+	long *ends;                /* Time point at which each segment ends */
+	uint64_t *hashes;          /* Hash of the schedule of each segment */
+	int miss_task;             /* Index of a task missing a deadline, or -1 */
+	int engine_miss_task;      /* The same with the unmodified engine */
+	double seconds;            /* Time taken to simulate all segments */
+};
+
+/*
+ * State shared by the workers of the recheck command.
+ */
+struct recheck_t {
+	struct certificate_t *certificate;
+	long *segments;   /* Indexes of the segments to recheck */
+	long num_segments;
+	pthread_mutex_t lock;
+	long next;        /* Index in segments of the next one to hand out */
+	long failed;      /* Segments that did not match the certificate */
+};
+
+struct recheck_t recheck = {NULL, NULL, 0, PTHREAD_MUTEX_INITIALIZER, 0, 0};
+
+/*
+ * Add the start of a run of the task with index task (-1 if the processor is
+ * idle) at time point t to the hash of a schedule.
+ */
+uint64_t hash_schedule(uint64_t hash, long t, int task) {
+	hash = (hash ^ (uint64_t)t) * SCHEDULE_HASH_PRIME;
+	return (hash ^ (uint64_t)(task + 1)) * SCHEDULE_HASH_PRIME;
+}
+
+/*
+ * Simulate the SAS from the state in the snapshot up to time point end (or
+ * to the end of the hyper-period), one time point at a time or from event to
+ * event (see simulate_sas_event_driven()). The task set is left in the state
+ * at end, after the job releases at end. The hash of the schedule is stored
+ * in *hash.
+ *
+ * Returns a pointer to the first task to miss a deadline, or NULL if all
+ * deadlines up to end are met.
+ */
+struct task_t *simulate_sas_segment(struct taskset_t *ts,
+		struct snapshot_t *start, long end, int event_driven,
+		uint64_t *hash) {
+	long t = restore_snapshot(ts, start);
+	long next_t;
+	struct task_t *hp_task;
+	int running = -2; /* Nothing has run in the segment yet */
+	*hash = SCHEDULE_HASH_BASIS;
+
+	while (t < end) {
+
+		/* Execute the highest-priority task and progress time. */
+		hp_task = get_highest_prio_active_task(ts, t);
+		int task = hp_task != NULL ? (int)(hp_task - ts->tasks) : -1;
+		if (task != running) {
+			*hash = hash_schedule(*hash, t, task);
+			running = task;
+		}
+		next_t = t + 1;
+		if (event_driven) {
+			next_t = get_next_event_time(ts, hp_task, t, end);
+		}
+		if (hp_task != NULL) {
+			hp_task->remaining_wcet -= next_t - t;
+		}
+		t = next_t;
+
+		if (t > ts->hyper_period) {
+			return NULL; /* No deadline misses in the SAS. */
+		}
+
+		/* Check for deadline misses. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			if (has_missed_deadline(&ts->tasks[i], t)) {
+				return &ts->tasks[i]; /* Return on first deadline miss. */
+			}
+		}
+
+		/* Release new jobs from all ready tasks. */
+		for (int i = 0; i < NUM_TASKS; i++) {
+			if (can_release(&ts->tasks[i], t)) {
+				release(&ts->tasks[i], t);
+			}
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Save the state of the SAS at time point 0, after the first job releases,
+ * to the snapshot.
+ */
+void save_initial_state(struct taskset_t *ts, struct snapshot_t *snapshot) {
+	reset_simulation_state(ts);
+	for (int i = 0; i < NUM_TASKS; i++) {
+		release(&ts->tasks[i], 0);
+	}
+	save_snapshot(snapshot, ts, 0);
+}
+
+/*
+ * Check if the snapshots hold the same state of the SAS.
+ */
+int is_same_state(struct snapshot_t *a, struct snapshot_t *b) {
+	int same = a->t == b->t;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		same = same && a->last_release_time[i] == b->last_release_time[i] &&
+			a->remaining_wcet[i] == b->remaining_wcet[i];
+	}
+	return same;
+}
+
+/*
+ * Allocate the segments of a certificate of the task set.
+ */
+void init_certificate(struct certificate_t *certificate,
+		struct taskset_t *ts, long num_segments) {
+	certificate->ts = *ts;
+	certificate->num_segments = num_segments;
+	certificate->starts = xmalloc(num_segments * sizeof(struct snapshot_t));
+	certificate->ends = xmalloc(num_segments * sizeof(long));
+	certificate->hashes = xmalloc(num_segments * sizeof(uint64_t));
+	certificate->miss_task = -1;
+	certificate->engine_miss_task = -1;
+}
+
+void destroy_certificate(struct certificate_t *certificate) {
+	free(certificate->starts);
+	free(certificate->ends);
+	free(certificate->hashes);
+}
+
+/*
+ * Simulate all segments of a certificate, each from the end of the one before
+ * it, and record their snapshots and hashes. Then simulate the whole
+ * hyper-period again with simulate_sas() (or simulate_sas_event_driven() if
+ * the certificate is event driven). The argument points to the certificate.
+ */
+void *certify_worker(void *arg) {
+	struct certificate_t *certificate = arg;
+	struct taskset_t *ts = &certificate->ts;
+	struct taskset_t engine_ts = *ts; /* The segments change ts */
+	long length = (ts->hyper_period + 1 + certificate->num_segments - 1) /
+		certificate->num_segments;
+	double start = get_seconds();
+
+	save_initial_state(ts, &certificate->starts[0]);
+	for (long k = 0; k < certificate->num_segments; k++) {
+		long end = k + 1 < certificate->num_segments ?
+			(k + 1) * length : ts->hyper_period + 1;
+		certificate->ends[k] = end;
+		struct task_t *miss_task = simulate_sas_segment(ts,
+				&certificate->starts[k], end, certificate->event_driven,
+				&certificate->hashes[k]);
+		if (miss_task != NULL) {
+			certificate->miss_task = miss_task - ts->tasks;
+			break;
+		}
+		if (k + 1 < certificate->num_segments) {
+			save_snapshot(&certificate->starts[k + 1], ts, end);
+		}
+	}
+	struct task_t *engine_miss_task = certificate->event_driven ?
+		simulate_sas_event_driven(&engine_ts) : simulate_sas(&engine_ts);
+	if (engine_miss_task != NULL) {
+		certificate->engine_miss_task = engine_miss_task - engine_ts.tasks;
+	}
+	certificate->seconds = get_seconds() - start;
+	return NULL;
+}
+
+/*
+ * Get the hash of the whole schedule, from the hashes of its segments.
+ */
+uint64_t get_certificate_hash(struct certificate_t *certificate) {
+	uint64_t hash = SCHEDULE_HASH_BASIS;
+	for (long k = 0; k < certificate->num_segments; k++) {
+		hash = (hash ^ certificate->hashes[k]) * SCHEDULE_HASH_PRIME;
+	}
+	return hash;
+}
+
+/*
+ * Write the certificate to the file at path.
+ */
+void write_certificate(const char *path, struct certificate_t *certificate) {
+	struct taskset_t *ts = &certificate->ts;
+	FILE *f = fopen(path, "w");
+	if (f == NULL) {
+		perror("Could not write certificate");
+		exit(EXIT_FAILURE);
+	}
+	fprintf(f, "dualpriotest certificate\ntasks");
+	for (int i = 0; i < NUM_TASKS; i++) {
+		fprintf(f, " %d %d %d %d %d", ts->tasks[i].wcet, ts->tasks[i].period,
+				ts->tasks[i].phase_1_prio, ts->tasks[i].phase_2_prio,
+				ts->tasks[i].phase_change_point);
+	}
+	fprintf(f, "\nhyper_period %ld\nsegments %ld\n", ts->hyper_period,
+			certificate->num_segments);
+	for (long k = 0; k < certificate->num_segments; k++) {
+		struct snapshot_t *start = &certificate->starts[k];
+		fprintf(f, "segment %ld %ld %016llx", start->t, certificate->ends[k],
+				(unsigned long long)certificate->hashes[k]);
+		for (int i = 0; i < NUM_TASKS; i++) {
+			fprintf(f, " %ld %d", start->last_release_time[i],
+					start->remaining_wcet[i]);
+		}
+		fprintf(f, "\n");
+	}
+	fprintf(f, "schedule %016llx\nend\n",
+			(unsigned long long)get_certificate_hash(certificate));
+	if (fclose(f) != 0) {
+		perror("Could not write certificate");
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * Read the certificate in the file at path, which is allocated. Exits the
+ * program if the certificate is malformed. The segments are not checked.
+ */
+void read_certificate(const char *path, struct certificate_t *certificate) {
+	FILE *f = fopen(path, "r");
+	if (f == NULL) {
+		perror("Could not read certificate");
+		exit(EXIT_FAILURE);
+	}
+
+	struct taskset_t ts;
+	memset(&ts, 0, sizeof(ts));
+	/* Set by %n only if the whole header matches. */
+	int header_length = 0;
+	int ok = fscanf(f, "dualpriotest certificate tasks%n",
+			&header_length) == 0 && header_length > 0;
+	for (int i = 0; i < NUM_TASKS; i++) {
+		struct task_t *task = &ts.tasks[i];
+		ok = ok && fscanf(f, "%d %d %d %d %d", &task->wcet, &task->period,
+				&task->phase_1_prio, &task->phase_2_prio,
+				&task->phase_change_point) == 5 &&
+			task->wcet >= 1 && task->wcet <= task->period &&
+			task->phase_change_point >= 0 &&
+			task->phase_change_point <= task->period;
+	}
+	long hyper_period_read, num_segments;
+	ok = ok && fscanf(f, " hyper_period %ld segments %ld", &hyper_period_read,
+			&num_segments) == 2 && num_segments >= 1 &&
+		num_segments <= CERTIFY_SEGMENTS;
+	ts.hyper_period = ok ? hyper_period(&ts) : 0;
+	ok = ok && hyper_period_read == ts.hyper_period &&
+		is_within_horizon(ts.hyper_period);
+	if (!ok) {
+		fprintf(stderr, "Certificate %s is malformed.\n", path);
+		exit(EXIT_FAILURE);
+	}
+
+	init_certificate(certificate, &ts, num_segments);
+	for (long k = 0; k < num_segments && ok; k++) {
+		struct snapshot_t *start = &certificate->starts[k];
+		unsigned long long hash;
+		ok = fscanf(f, " segment %ld %ld %llx", &start->t,
+				&certificate->ends[k], &hash) == 3 &&
+			start->t == (k == 0 ? 0 : certificate->ends[k - 1]) &&
+			certificate->ends[k] > start->t &&
+			certificate->ends[k] <= ts.hyper_period + 1;
+		certificate->hashes[k] = hash;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			ok = ok && fscanf(f, "%ld %d", &start->last_release_time[i],
+					&start->remaining_wcet[i]) == 2;
+			start->min_phase_2_age[i] = LONG_MAX;
+			start->phase_change_point[i] = ts.tasks[i].phase_change_point;
+		}
+	}
+	unsigned long long schedule_hash;
+	char end[4];
+	ok = ok && certificate->ends[num_segments - 1] == ts.hyper_period + 1 &&
+		fscanf(f, " schedule %llx", &schedule_hash) == 1 &&
+		schedule_hash == get_certificate_hash(certificate) &&
+		fscanf(f, " %3s", end) == 1 && strcmp(end, "end") == 0;
+	fclose(f);
+
+	if (!ok) {
+		fprintf(stderr, "Certificate %s is malformed.\n", path);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*
+ * Certify a configuration of a task set given as FILE and four tasks (see
+ * parse_trace_task()) with segmented simulations in two modes and with the
+ * tick and event engines, and write the certificate to FILE.
+ */
+void run_certify(char **args, int num_args) {
+	if (num_args != NUM_TASKS + 1) {
+		fprintf(stderr, "Expected a certificate file and %d tasks as "
+				"W,P,PRIO1,PRIO2,PCP.\n", NUM_TASKS);
+		exit(EXIT_FAILURE);
+	}
+	struct taskset_t ts;
+	memset(&ts, 0, sizeof(ts));
+	for (int i = 0; i < NUM_TASKS; i++) {
+		parse_trace_task(&ts.tasks[i], args[i + 1]);
+	}
+	ts.hyper_period = hyper_period(&ts);
+	exit_if_beyond_horizon(ts.hyper_period);
+
+	/* One simulation per time point and one per event, concurrently. */
+	long num_segments = ts.hyper_period + 1 < CERTIFY_SEGMENTS ?
+		ts.hyper_period + 1 : CERTIFY_SEGMENTS;
+	struct certificate_t certificates[2];
+	pthread_t threads[2];
+	double start = get_seconds();
+	for (int e = 0; e < 2; e++) {
+		init_certificate(&certificates[e], &ts, num_segments);
+		certificates[e].event_driven = e;
+		if (pthread_create(&threads[e], NULL, certify_worker,
+					&certificates[e])) {
+			fprintf(stderr, "Could not create certify thread.\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	for (int e = 0; e < 2; e++) {
+		pthread_join(threads[e], NULL);
+	}
+	double seconds = get_seconds() - start;
+
+	const char *engine_names[] = {"tick", "event"};
+	long agreed = 0; /* Segments on which both modes agree */
+	int engines_meet_deadlines = 1;
+	for (int e = 0; e < 2; e++) {
+		printf("Mode %-5s simulated ", engine_names[e]);
+		if (certificates[e].miss_task >= 0) {
+			printf("up to a deadline miss of T%d",
+					certificates[e].miss_task + 1);
+		} else {
+			printf("%ld segments without deadline misses", num_segments);
+		}
+		printf(", and the %s engine ", engine_names[e]);
+		if (certificates[e].engine_miss_task >= 0) {
+			printf("misses a deadline of T%d",
+					certificates[e].engine_miss_task + 1);
+			engines_meet_deadlines = 0;
+		} else {
+			printf("meets all deadlines");
+		}
+		printf(" in %.2f s.\n", certificates[e].seconds);
+	}
+	while (certificates[0].miss_task < 0 && certificates[1].miss_task < 0 &&
+			agreed < num_segments &&
+			is_same_state(&certificates[0].starts[agreed],
+				&certificates[1].starts[agreed]) &&
+			certificates[0].hashes[agreed] == certificates[1].hashes[agreed]) {
+		agreed++;
+	}
+	if (agreed < num_segments || !engines_meet_deadlines) {
+		if (certificates[0].miss_task < 0 && certificates[1].miss_task < 0 &&
+				agreed < num_segments) {
+			printf("The modes disagree on segment %ld, from time %ld.\n",
+					agreed + 1, certificates[0].starts[agreed].t);
+		}
+		printf("The configuration is not certified.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	write_certificate(args[0], &certificates[0]);
+	printf("Certified: both modes agree on all %ld segments of the "
+			"hyper-period %ld (schedule hash %016llx, %.2f s).\nWrote the "
+			"certificate to %s.\n", num_segments, ts.hyper_period,
+			(unsigned long long)get_certificate_hash(&certificates[0]),
+			seconds, args[0]);
+	for (int e = 0; e < 2; e++) {
+		destroy_certificate(&certificates[e]);
+	}
+}
+
+/*
+ * Recheck segments of the certificate of the recheck until all have been
+ * handed out.
+ */
+void *recheck_worker(void *arg) {
+	(void)arg;
+	struct certificate_t *certificate = recheck.certificate;
+	struct taskset_t ts = certificate->ts;
+	while (1) {
+		pthread_mutex_lock(&recheck.lock);
+		long i = recheck.next;
+		recheck.next++;
+		pthread_mutex_unlock(&recheck.lock);
+		if (i >= recheck.num_segments) {
+			break;
+		}
+
+		long k = recheck.segments[i];
+		uint64_t hash;
+		struct snapshot_t end_state;
+		struct task_t *miss_task = simulate_sas_segment(&ts,
+				&certificate->starts[k], certificate->ends[k], 0, &hash);
+		int ok = miss_task == NULL && hash == certificate->hashes[k];
+		if (ok && k + 1 < certificate->num_segments) {
+			save_snapshot(&end_state, &ts, certificate->ends[k]);
+			ok = is_same_state(&end_state, &certificate->starts[k + 1]);
+		}
+		if (!ok) {
+			lock_output();
+			printf("Segment %ld (from time %ld to %ld) does not match the "
+					"certificate.\n", k + 1, certificate->starts[k].t,
+					certificate->ends[k]);
+			unlock_output();
+			pthread_mutex_lock(&recheck.lock);
+			recheck.failed++;
+			pthread_mutex_unlock(&recheck.lock);
+		}
+	}
+	return NULL;
+}
+
+/*
+ * Recheck COUNT random segments (default all) of the certificate in FILE with
+ * options.num_threads workers, chosen with the random SEED (default the
+ * time).
+ */
+void run_recheck(char **args, int num_args) {
+	if (num_args < 1 || num_args > 3) {
+		fprintf(stderr, "Expected a certificate file, and optionally a "
+				"number of segments and a seed.\n");
+		exit(EXIT_FAILURE);
+	}
+	struct certificate_t certificate;
+	read_certificate(args[0], &certificate);
+	long count = num_args > 1 ? atol(args[1]) : certificate.num_segments;
+	unsigned int seed = num_args > 2 ? (unsigned int)atol(args[2]) :
+		(unsigned int)time(NULL);
+	if (count < 1 || count > certificate.num_segments) {
+		fprintf(stderr, "Expected a number of segments between 1 and %ld.\n",
+				certificate.num_segments);
+		exit(EXIT_FAILURE);
+	}
+
+	/* The first segment must start in the initial state of the SAS. */
+	struct snapshot_t initial_state;
+	save_initial_state(&certificate.ts, &initial_state);
+	if (!is_same_state(&initial_state, &certificate.starts[0])) {
+		printf("The certificate does not start in the initial state.\n");
+		exit(EXIT_FAILURE);
+	}
+
+	/* Choose the first count of a random permutation of the segments. */
+	long *segments = xmalloc(certificate.num_segments * sizeof(long));
+	for (long k = 0; k < certificate.num_segments; k++) {
+		segments[k] = k;
+	}
+	srand(seed);
+	for (long k = 0; k < count; k++) {
+		long j = k + rand() % (certificate.num_segments - k);
+		long temp = segments[k];
+		segments[k] = segments[j];
+		segments[j] = temp;
+	}
+
+	recheck.certificate = &certificate;
+	recheck.segments = segments;
+	recheck.num_segments = count;
+	recheck.next = 0;
+	recheck.failed = 0;
+	double start = get_seconds();
+	pthread_t threads[MAX_THREADS];
+	for (int i = 0; i < options.num_threads; i++) {
+		if (pthread_create(&threads[i], NULL, recheck_worker, NULL)) {
+			fprintf(stderr, "Could not create worker thread.\n");
+			exit(EXIT_FAILURE);
 		}
 	}
+	for (int i = 0; i < options.num_threads; i++) {
+		pthread_join(threads[i], NULL);
+	}
+	double seconds = get_seconds() - start;
+	free(segments);
+	destroy_certificate(&certificate);
+
+	if (recheck.failed > 0) {
+		printf("%ld of %ld rechecked segments do not match the certificate."
+				"\n", recheck.failed, count);
+		exit(EXIT_FAILURE);
+	}
+	printf("Rechecked %ld of %ld segments (seed %u) in %.2f s: all match the "
+			"certificate.\n", count, certificate.num_segments, seed, seconds);
 }
 
 /*
- * Test whether the task set is dual-priority schedulable with any setting
- * of the phase change points with the current priority ordering. The phase
- * change point of each task will range between 0 and the task's period. Works
- * by simulating the SAS until the first deadline miss for all settings of the 
- * phase change points, or until a schedulable configuration is found. 
- *
- * Returns 1 if any schedulable configuration of the phase change points exists
- * with the current priorities, returns 0 otherwise.
+ * ============================================================================
+ * Benchmark of the simulators of the SAS ("bench" command).
  *
- * Precondition: The task set has four tasks, with phase 1 and phase 2
- *               priorities already set.
+ * Each engine simulates a fixed configuration of each of the three
+ * counterexample task sets over and over. A trial lasts for at least
+ * BENCH_MIN_SECONDS, and the results of the trials (after one warmup trial)
+ * are summarized by their median, minimum and maximum.
+ * ============================================================================
  */
-int test_all_phase_change_points(struct taskset_t *ts) {
-	const long total_combinations =	(ts->tasks[0].period + 1) * 
-	                                (ts->tasks[1].period + 1) * 
-	                                (ts->tasks[2].period + 1) * 
-	                                (ts->tasks[3].period + 1);
-	long generated_combinations = 0;
-
-	printf("Testing all %ld possible combinations of phase change points...\n",
-			total_combinations);
 
-	/*
-	 * Naively generate all combinations of phase change points.
-	 * T1pcp becomes the phase change point of task T1 etc.
-	 */
-	for (int T1pcp = 0; T1pcp <= ts->tasks[0].period; T1pcp++) {
-		ts->tasks[0].phase_change_point = T1pcp;
-
-		for (int T2pcp = 0; T2pcp <= ts->tasks[1].period; T2pcp++) {
-			ts->tasks[1].phase_change_point = T2pcp;
+#define BENCH_MIN_SECONDS 0.2
 
-			for (int T3pcp = 0; T3pcp <= ts->tasks[2].period; T3pcp++) {
-				ts->tasks[2].phase_change_point = T3pcp;
+volatile int bench_sink; /* Keeps the compiler from removing simulations */
 
-				for (int T4pcp = 0; T4pcp <= ts->tasks[3].period; T4pcp++) {
-					ts->tasks[3].phase_change_point = T4pcp;
+/*
+ * Get the number of time points that simulate_sas() goes through for the task
+ * set: up to and including the first deadline miss, or the whole hyper-period.
+ */
+long count_ticks(struct taskset_t *ts) {
+	struct task_t *miss_task = simulate_sas(ts);
+	if (miss_task == NULL) {
+		return ts->hyper_period + 1;
+	}
+	return miss_task->last_release_time + miss_task->period + 1;
+}
 
-					generated_combinations++;
-					
-					if (VERBOSE) {
-						printf("Testing phase change point combination "
-								"%ld of %ld...\n",
-								generated_combinations,
-							   	total_combinations);
-						print_taskset(ts, 1, 1);
-					}
-					if (simulate_sas(ts) == NULL) { /* SAS is schedulable */
-						printf("Schedulable with this configuration:\n\n");
-						print_taskset(ts, 1, 1);
-						return 1; /* Return if a valid setting is found. */
-					} else if (VERBOSE) {
-						printf("Unschedulable with this configuration.\n\n");
-					}
-				}
-			}
-		}
+/*
+ * Simulate the SAS of the task set once with the engine. For the simd engine,
+ * BATCH_LANES simulations are made at once, with the phase change points of T4
+ * in last_pcp.
+ */
+void bench_engine_once(struct taskset_t *ts, enum engine_t engine,
+		const uint8_t *last_pcp) {
+	if (engine == ENGINE_SIMD) {
+		struct compact_taskset_t cts;
+		compact_taskset(&cts, ts);
+		bench_sink = simulate_sas_batch(&cts, last_pcp, BATCH_LANES);
+	} else {
+		options.engine = engine;
+		bench_sink = simulate(ts) == NULL;
 	}
-	assert(generated_combinations == total_combinations);
-	return 0; /* Not schedulable with any promotion points. */
 }
 
 /*
- * Test dual priority schedulability exhaustively by simulating the SAS for
- * all possible configurations of priorities and phase change points.
- *
- * Returns 1 if there exists a schedulable configuration, otherwise returns 0.
- *
- * Precondition: The task set has four tasks.
- *
- * There are 8! = 40320 possible permutations of the 8 priority values
- * (each task has 2 priorities). These will all be generated.
+ * Run one trial of the engine on the task set, lasting at least
+ * BENCH_MIN_SECONDS.
  *
- * For each priority permutation, test_all_phase_change_point_combinatios()
- * is called to simulate thet SAS with all possible settings of the phase
- * change points.
+ * Returns the number of seconds per call of bench_engine_once().
  */
-int test_all_configurations_exhaustively(struct taskset_t *ts) {
-	const long total_permutations = 8*7*6*5*4*3*2*1; /* 8! = 40320 */
-	long generated_permutations = 0;
-
-	/*
-	 * Naively generate all permutations of priorities.
-	 * T1p2 becomes the phase 2 priority of task T1 etc.
-	 */
-	for (int T1p2 = 0; T1p2 < 8; T1p2++) {
-		ts->tasks[0].phase_2_prio = T1p2;
+double bench_trial(struct taskset_t *ts, enum engine_t engine,
+		const uint8_t *last_pcp) {
+	long calls = 0;
+	double start = get_seconds();
+	double elapsed;
+	do {
+		bench_engine_once(ts, engine, last_pcp);
+		calls++;
+		elapsed = get_seconds() - start;
+	} while (elapsed < BENCH_MIN_SECONDS);
+	return elapsed / calls;
+}
 
-		for (int T2p2 = 0; T2p2 < 8; T2p2++) {
-			if (T2p2 == T1p2) continue;
-			ts->tasks[1].phase_2_prio = T2p2;
+int compare_doubles(const void *a, const void *b) {
+	double x = *(const double *)a;
+	double y = *(const double *)b;
+	return (x > y) - (x < y);
+}
 
-			for (int T3p2 = 0; T3p2 < 8; T3p2++) {
-				if (T3p2 == T1p2) continue;
-				if (T3p2 == T2p2) continue;
-				ts->tasks[2].phase_2_prio = T3p2;
+/*
+ * Benchmark all engines on the three counterexample task sets, with the
+ * number of trials given in the arguments (default 5).
+ *
+ * The configurations are a long run that ends in a deadline miss for
+ * counterexample 1, and the schedulable configurations of tests 2 and 3,
+ * which are simulated for the whole hyper-period.
+ */
+void run_benchmark(char **args, int num_args) {
+	int trials = num_args > 0 ? atoi(args[0]) : 5;
+	if (num_args > 1 || trials < 1 || trials > 1000) {
+		fprintf(stderr, "Expected a number of trials between 1 and 1000.\n");
+		exit(EXIT_FAILURE);
+	}
 
-				for (int T4p2 = 0; T4p2 < 8; T4p2++) {
-					if (T4p2 == T1p2) continue;
-					if (T4p2 == T2p2) continue;
-					if (T4p2 == T3p2) continue;
-					ts->tasks[3].phase_2_prio = T4p2;
+	int W[3][NUM_TASKS] = {{8, 13, 9, 14}, {13, 17, 4, 28}, {6, 6, 4, 5}};
+	int P[3][NUM_TASKS] = {{19, 29, 151, 197}, {29, 47, 89, 193},
+		{11, 20, 46, 74}};
+	int P1[3][NUM_TASKS] = {{4, 5, 6, 7}, {4, 5, 7, 6}, {4, 5, 6, 7}};
+	int P2[3][NUM_TASKS] = {{0, 1, 2, 3}, {0, 1, 2, 3}, {0, 1, 2, 3}};
+	int PCP[3][NUM_TASKS] = {{11, 0, 84, 72}, {13, 17, 42, 139},
+		{5, 3, 25, 35}};
+	enum engine_t engines[] = {
+		ENGINE_TICK, ENGINE_EVENT, ENGINE_TABLE, ENGINE_COMPACT, ENGINE_SIMD,
+		ENGINE_COUNTDOWN
+	};
+	const char *engine_names[] = {"tick", "event", "table", "compact", "simd",
+		"countdown"};
+	enum engine_t saved_engine = options.engine;
+	double *ns_per_tick = xmalloc(trials * sizeof(double));
 
-					for (int T1p1 = 0; T1p1 < 8; T1p1++) {
-						if (T1p1 == T1p2) continue;
-						if (T1p1 == T2p2) continue;
-						if (T1p1 == T3p2) continue;
-						if (T1p1 == T4p2) continue;
-						ts->tasks[0].phase_1_prio = T1p1;
+	printf("Benchmark of the SAS simulators: %d trials of at least %.1f s, "
+			"after one warmup trial.\n\n", trials, BENCH_MIN_SECONDS);
+	printf("%-5s %-9s %12s %12s %14s %10s %21s\n", "Test", "Engine",
+			"Ticks/run", "Runs/s", "Ticks/s", "ns/tick", "(min-max)");
 
-						for (int T2p1 = 0; T2p1 < 8; T2p1++) {
-							if (T2p1 == T1p2) continue;
-							if (T2p1 == T2p2) continue;
-							if (T2p1 == T3p2) continue;
-							if (T2p1 == T4p2) continue;
-							if (T2p1 == T1p1) continue;
-							ts->tasks[1].phase_1_prio = T2p1;
+	for (int c = 0; c < 3; c++) {
+		struct taskset_t ts;
+		for (int i = 0; i < NUM_TASKS; i++) {
+			ts.tasks[i].wcet = W[c][i];
+			ts.tasks[i].period = P[c][i];
+			ts.tasks[i].phase_1_prio = P1[c][i];
+			ts.tasks[i].phase_2_prio = P2[c][i];
+			ts.tasks[i].phase_change_point = PCP[c][i];
+		}
+		ts.hyper_period = hyper_period(&ts);
+		long ticks_per_run = count_ticks(&ts);
 
-							for (int T3p1 = 0; T3p1 < 8; T3p1++) {
-								if (T3p1 == T1p2) continue;
-								if (T3p1 == T2p2) continue;
-								if (T3p1 == T3p2) continue;
-								if (T3p1 == T4p2) continue;
-								if (T3p1 == T1p1) continue;
-								if (T3p1 == T2p1) continue;
-								ts->tasks[2].phase_1_prio = T3p1;
+		/* The simd engine simulates neighbouring phase change points of T4 */
+		uint8_t last_pcp[BATCH_LANES];
+		long ticks_per_batch = 0;
+		for (int lane = 0; lane < BATCH_LANES; lane++) {
+			last_pcp[lane] = (PCP[c][3] + lane) % (P[c][3] + 1);
+			ts.tasks[3].phase_change_point = last_pcp[lane];
+			ticks_per_batch += count_ticks(&ts);
+		}
+		ts.tasks[3].phase_change_point = PCP[c][3];
 
-								for (int T4p1 = 0; T4p1 < 8; T4p1++) {
-									if (T4p1 == T1p2) continue;
-									if (T4p1 == T2p2) continue;
-									if (T4p1 == T3p2) continue;
-									if (T4p1 == T4p2) continue;
-									if (T4p1 == T1p1) continue;
-									if (T4p1 == T2p1) continue;
-									if (T4p1 == T3p1) continue;
-									ts->tasks[3].phase_1_prio = T4p1;
-									
-									generated_permutations++;
+		for (int e = 0; e < (int)(sizeof(engines) / sizeof(engines[0])); e++) {
+			int runs = engines[e] == ENGINE_SIMD ? BATCH_LANES : 1;
+			long ticks = engines[e] == ENGINE_SIMD ?
+				ticks_per_batch : ticks_per_run;
 
-									printf("Generated priority permutation "
-										"%ld of %ld...\n",
-										generated_permutations, 
-										total_permutations);
-									print_taskset(ts, 1, 0);
-
-									/*
-									 * Test all possible combinations of phase
-									 * change points with these priorities by
-									 * simulating the SAS.
-									 */
-									if (test_all_phase_change_points(ts)) {
-										return 1; /* Return if schedulable */
-									}
-									printf("Unschedulable for all combinations "
-										   "of phase change points.\n\n");
-								}
-							}
-						}
-					}
-				}
+			bench_trial(&ts, engines[e], last_pcp); /* Warmup */
+			for (int k = 0; k < trials; k++) {
+				double seconds = bench_trial(&ts, engines[e], last_pcp);
+				ns_per_tick[k] = seconds * 1e9 / ticks;
 			}
+			qsort(ns_per_tick, trials, sizeof(double), compare_doubles);
+			double median = trials % 2 ? ns_per_tick[trials / 2] :
+				(ns_per_tick[trials / 2 - 1] + ns_per_tick[trials / 2]) / 2;
+
+			printf("%-5d %-9s %12ld %12.1f %14.4g %10.3f (%8.3f - %8.3f)\n",
+					c + 1,
+					engine_names[e],
+					ticks / runs,
+					1e9 / (median * ticks) * runs,
+					1e9 / median,
+					median,
+					ns_per_tick[0],
+					ns_per_tick[trials - 1]);
 		}
 	}
-	/* Not schedulable with any priority permutation */
-	assert(generated_permutations == total_permutations);
-	printf("Task set is not dual-priority schedulable!\n");
-	return 0; 
+
+	options.engine = saved_engine;
+	free(ns_per_tick);
 }
 
 /*
- * Test dual priority schedulability exhaustively by simulating the SAS for
- * all possible configurations of priorities and phase change points, under the
- * restriction that the phase 1 priorities of the tasks are Rate Monotonic.
- *
- * Returns 1 if there is such a schedulable configuration, otherwise returns 0.
- *
- * Precondition: The task set has four tasks sorted in Rate Monotonic order.
- *
- * There are binomial(8, 4) * 4! = 8! / 4! = 1680 possible priority
- * permutations here. These will all be generated.
- *
- * For each priority permutation, test_all_phase_change_point_combinatios()
- * is called to simulate thet SAS with all possible settings of the phase
- * change points.
+ * Parameters of the scaling benchmark, which the workers only read.
  */
-int test_rm_configurations_exhaustively(struct taskset_t *ts) {
-	const long total_permutations = 8*7*6*5; /* 8!/4! = 1680 */
-	long generated_permutations = 0;
-
-	/*
-	 * Naively generate all permutations of priorities, where the phase 1
-	 * priorities are Rate Monotonic.
-	 * T1p2 becomes the phase 2 priority of task T1 etc.
-	 */
-	for (int T1p1 = 0; T1p1 < 8; T1p1++) {
-		ts->tasks[0].phase_1_prio = T1p1;
-
-		for (int T2p1 = T1p1 + 1; T2p1 < 8; T2p1++) {
-			ts->tasks[1].phase_1_prio = T2p1;
-
-			for (int T3p1 = T2p1 + 1; T3p1 < 8; T3p1++) {
-				ts->tasks[2].phase_1_prio = T3p1;
+struct scaling_t {
+	struct taskset_t ts; /* Schedulable configuration of test 3 */
+	double end_time;     /* When the workers stop, see get_seconds() */
+};
 
-				for (int T4p1 = T3p1 + 1; T4p1 < 8; T4p1++) {
-					ts->tasks[3].phase_1_prio = T4p1;
+struct scaling_t scaling;
 
-					for (int T1p2 = 0; T1p2 < 8; T1p2++) {
-						if (T1p2 == T1p1) continue;
-						if (T1p2 == T2p1) continue;
-						if (T1p2 == T3p1) continue;
-						if (T1p2 == T4p1) continue;
-						ts->tasks[0].phase_2_prio = T1p2;
+/*
+ * Worker of the scaling benchmark, whose index the argument points to.
+ * Simulates the whole hyper-period of the task set over and over, on the copy
+ * in its own worker context, until the end time.
+ */
+void *scaling_worker(void *arg) {
+	struct worker_t *worker = init_worker(&worker_arena, *(int *)arg,
+			&scaling.ts);
+	do {
+		bench_sink = simulate_sas(&worker->ts) == NULL;
+		worker->simulations++;
+	} while (get_seconds() < scaling.end_time);
+	release_worker(worker);
+	return NULL;
+}
 
-						for (int T2p2 = 0; T2p2 < 8; T2p2++) {
-							if (T2p2 == T1p1) continue;
-							if (T2p2 == T2p1) continue;
-							if (T2p2 == T3p1) continue;
-							if (T2p2 == T4p1) continue;
-							if (T2p2 == T1p2) continue;
-							ts->tasks[1].phase_2_prio = T2p2;
+/*
+ * Measure the throughput of simulate_sas() with 1, 2, 4, ... and finally
+ * options.num_threads worker threads, each running for the number of seconds
+ * given in the arguments (default 2). With perfect scaling, the throughput per
+ * thread stays the same as long as there are enough CPUs.
+ */
+void run_scaling_benchmark(char **args, int num_args) {
+	int seconds = num_args > 0 ? atoi(args[0]) : 2;
+	if (num_args > 1 || seconds < 1 || seconds > 3600) {
+		fprintf(stderr, "Expected a number of seconds between 1 and 3600.\n");
+		exit(EXIT_FAILURE);
+	}
 
-							for (int T3p2 = 0; T3p2 < 8; T3p2++) {
-								if (T3p2 == T1p1) continue;
-								if (T3p2 == T2p1) continue;
-								if (T3p2 == T3p1) continue;
-								if (T3p2 == T4p1) continue;
-								if (T3p2 == T1p2) continue;
-								if (T3p2 == T2p2) continue;
-								ts->tasks[2].phase_2_prio = T3p2;
+	int W[NUM_TASKS] = {6, 6, 4, 5};
+	int P[NUM_TASKS] = {11, 20, 46, 74};
+	int PCP[NUM_TASKS] = {5, 3, 25, 35};
+	memset(&scaling.ts, 0, sizeof(scaling.ts));
+	for (int i = 0; i < NUM_TASKS; i++) {
+		scaling.ts.tasks[i].wcet = W[i];
+		scaling.ts.tasks[i].period = P[i];
+		scaling.ts.tasks[i].phase_1_prio = NUM_TASKS + i;
+		scaling.ts.tasks[i].phase_2_prio = i;
+		scaling.ts.tasks[i].phase_change_point = PCP[i];
+	}
+	scaling.ts.hyper_period = hyper_period(&scaling.ts);
+	long ticks_per_run = count_ticks(&scaling.ts);
 
-								for (int T4p2 = 0; T4p2 < 8; T4p2++) {
-									if (T4p2 == T1p1) continue;
-									if (T4p2 == T2p1) continue;
-									if (T4p2 == T3p1) continue;
-									if (T4p2 == T4p1) continue;
-									if (T4p2 == T1p2) continue;
-									if (T4p2 == T2p2) continue;
-									if (T4p2 == T3p2) continue;
-									ts->tasks[3].phase_2_prio = T4p2;
-									
-									generated_permutations++;
+	printf("Scaling of simulate_sas() on test 3: up to %d threads, %d s per "
+			"step, CPUs online: %ld.\n\n", options.num_threads, seconds,
+			sysconf(_SC_NPROCESSORS_ONLN));
+	printf("%-8s %12s %14s %14s %8s %11s\n", "Threads", "Runs/s",
+			"Ticks/s", "Ticks/s/thread", "Speedup", "Efficiency");
 
-									printf("Generated priority permutation "
-										"%ld of %ld...\n",
-										generated_permutations, 
-										total_permutations);
-									print_taskset(ts, 1, 0);
-									
-									/*
-									 * Test all possible combinations of phase
-									 * change points with these priorities by
-									 * simulating the SAS.
-									 */
-									if (test_all_phase_change_points(ts)) {
-										return 1; /* Return if schedulable */
-									}
-									printf("Unschedulable for all combinations "
-										   "of phase change points.\n\n");
-								}
-							}
-						}
-					}
-				}
+	double single = 0;
+	int worker_ids[MAX_THREADS];
+	for (int n = 1; n <= options.num_threads;
+			n = n < options.num_threads && n * 2 > options.num_threads ?
+			options.num_threads : n * 2) {
+		pthread_t threads[MAX_THREADS];
+		create_worker_arena(&worker_arena, n, &scaling.ts);
+		double start = get_seconds();
+		scaling.end_time = start + seconds;
+		for (int w = 0; w < n; w++) {
+			worker_ids[w] = w;
+			if (pthread_create(&threads[w], NULL, scaling_worker,
+						&worker_ids[w])) {
+				fprintf(stderr, "Could not create worker thread.\n");
+				exit(EXIT_FAILURE);
 			}
 		}
+		long runs = 0;
+		for (int w = 0; w < n; w++) {
+			pthread_join(threads[w], NULL);
+			runs += get_worker(&worker_arena, w)->simulations;
+		}
+		double elapsed = get_seconds() - start;
+		destroy_worker_arena(&worker_arena);
+
+		double ticks_per_second = runs * ticks_per_run / elapsed;
+		if (n == 1) {
+			single = ticks_per_second;
+		}
+		printf("%-8d %12.1f %14.4g %14.4g %8.2f %10.0f%%\n",
+				n,
+				runs / elapsed,
+				ticks_per_second,
+				ticks_per_second / n,
+				ticks_per_second / single,
+				100 * ticks_per_second / single / n);
 	}
-	/* Not schedulable with any priority permutation */
-	assert(generated_permutations == total_permutations);
-	printf("Task set is not dual-priority schedulable with RM for phase 1!\n");
-	return 0; 
 }
 
 /*
@@ -603,6 +6967,20 @@ void verify_counterexample_1() {
 		printf("\nTest 1 failed: task set is schedulable.\n");
 		exit(EXIT_FAILURE);
 	}
+	if (options.bisect) {
+		/* The bisection may have skipped a schedulable configuration. */
+		printf("\nTest 1 is not finished, as -b is no proof.\n");
+		return;
+	}
+	if (options.num_shards > 1) {
+		/* The other shards may still hold a schedulable permutation. */
+		printf("\nOnly shard %d/%d was tested: test 1 is finished when all %d "
+				"shards report schedulable=no.\n",
+				options.shard,
+				options.num_shards,
+				options.num_shards);
+		return;
+	}
 
 	printf("\nSuccessfully finished test 1.\n");
 }
@@ -682,6 +7060,20 @@ void verify_counterexample_2() {
 		printf("\nTest 2 failed: task set schedulable with RM for phase 1.\n");
 		exit(EXIT_FAILURE);
 	}
+	if (options.bisect) {
+		/* The bisection may have skipped a schedulable configuration. */
+		printf("\nTest 2 is not finished, as -b is no proof.\n");
+		return;
+	}
+	if (options.num_shards > 1) {
+		/* The other shards may still hold a schedulable permutation. */
+		printf("\nOnly shard %d/%d was tested: test 2 is finished when all %d "
+				"shards report schedulable=no.\n",
+				options.shard,
+				options.num_shards,
+				options.num_shards);
+		return;
+	}
 
 	printf("\nTesting custom configuration...\n");
 	ts.tasks[0].phase_1_prio = 4; ts.tasks[0].phase_2_prio = 0;
@@ -693,7 +7085,7 @@ void verify_counterexample_2() {
 	ts.tasks[2].phase_change_point = 42;
 	ts.tasks[3].phase_change_point = 139;
 	print_taskset(&ts, 1, 1);
-	if (simulate_sas(&ts) != NULL) { /* Will not happen */
+	if (simulate(&ts) != NULL) { /* Will not happen */
 		printf("\nTest 2 failed: custom configuration not schedulable.\n");
 		exit(EXIT_FAILURE);
 	}
@@ -775,7 +7167,7 @@ void verify_counterexample_3() {
 	ts.tasks[2].phase_change_point = 25;
 	ts.tasks[3].phase_change_point = 35;
 	print_taskset(&ts, 1, 1);
-	if (simulate_sas(&ts) != NULL) { /* Will not happen */
+	if (simulate(&ts) != NULL) { /* Will not happen */
 		printf("\nTest 3 failed: custom configuration not schedulable.\n");
 		exit(EXIT_FAILURE);
 	}
@@ -789,25 +7181,330 @@ void print_help_and_exit() {
 		"This program simulates dual priority scheduling of periodic tasks\n"
 		"and verifies the counterexamples given in the paper entitled\n"
 		"\"Dual Priority Scheduling is Not Optimal\".\n\n"
-		"Usage: dualpriotest TEST_NUM\n\n"
+		"Usage: dualpriotest [OPTIONS] TEST_NUM\n"
+		"       dualpriotest [OPTIONS] COMMAND [ARGS]\n\n"
 		"where TEST_NUM is 1, 2, or 3.\n\n"
 		"Test 1: Show the suboptimality of dual priority scheduling.\n"
 		"        Counterexample 8 in the paper (very, very slow).\n\n"
 		"Test 2: Show the suboptimality of RM ordering of phase 1 priorities\n"
 		"        Counterexample 9 in the paper (very slow).\n\n"
 		"Test 3: Show the suboptimality of FDMS phase change points\n"
-		"        Counterexample 10 in the paper (fast).\n";
-	printf("%s", help);
+		"        Counterexample 10 in the paper (fast).\n\n"
+		"Commands:\n\n"
+		"search WCET,PERIOD ...\n"
+		"        Exhaustively test a task set of GEN_TASKS tasks (set when\n"
+		"        compiling, e.g., make GEN_TASKS=5) with the generic search.\n\n"
+		"selfcheck\n"
+		"        Check the generic search against the naive search, and\n"
+		"        all engines against each other (needs GEN_TASKS = 4).\n\n"
+		"bench [TRIALS]\n"
+		"        Measure the speed of each simulator engine on the three\n"
+		"        counterexamples, over TRIALS trials (default 5).\n\n"
+		"scaling [SECONDS]\n"
+		"        Measure the throughput of simulate_sas() with 1, 2, 4,\n"
+		"        ... up to N worker threads (-j N), for SECONDS seconds\n"
+		"        each (default 2).\n\n"
+		"sweep [FILE]\n"
+		"        Test each task set in FILE (or on standard input), one\n"
+		"        per line as four WCET,PERIOD, with fixed-priority RM and\n"
+		"        with FDMS, and print one verdict line per task set.\n\n"
+		"trace FILE W,P,PRIO1,PRIO2,PCP ...\n"
+		"        Simulate four tasks with the given phase 1 and phase 2\n"
+		"        priorities and phase change points, and write a binary\n"
+		"        trace of the scheduling events to FILE.\n\n"
+		"decode FILE [text|gantt]\n"
+		"        Print a trace FILE as text (default) or as a CSV file of\n"
+		"        the runs of each task for a Gantt chart.\n\n"
+		"certify FILE W,P,PRIO1,PRIO2,PCP ...\n"
+		"        Like trace, but check that the configuration is\n"
+		"        schedulable with the tick and event engines and with\n"
+		"        segmented simulations in both modes, on two threads,\n"
+		"        and write a certificate of its schedule to FILE.\n\n"
+		"recheck FILE [COUNT [SEED]]\n"
+		"        Simulate COUNT random segments (default all) of the\n"
+		"        certificate in FILE again, in parallel (-j N).\n\n";
+	char *options_help = \
+		"Options:\n\n"
+		"-j N    Test priority permutations (or the task sets of a sweep)\n"
+		"        in parallel using N worker threads (default 1).\n\n"
+		"-e ENGINE\n"
+		"        Simulate the SAS with ENGINE, which is one of:\n"
+		"        tick   advance time one unit at a time (default)\n"
+		"        event  jump directly between scheduling events\n"
+		"        table  like tick, but looks up the task to run in a\n"
+		"               table built for each priority permutation\n"
+		"        compact  like tick, but on narrow per-task arrays\n"
+		"        simd   like compact, but simulates many phase change\n"
+		"               points of T4 at once (not combined with -p)\n"
+		"        countdown  like tick, but counts down the time to the\n"
+		"               next release and phase change of each task\n"
+		"        gpu    simulate all phase change points of T2..T4 at\n"
+		"               once with OpenCL (needs make OPENCL=1, not\n"
+		"               combined with -p, -f, -m or -s)\n\n"
+		"-p      Skip combinations of phase change points that provably\n"
+		"        give the same deadline miss as an already simulated\n"
+		"        combination.\n\n"
+		"-s      Resume each simulation from the schedule prefix it shares\n"
+		"        with the previous one, instead of restarting at time 0\n"
+		"        (also in the FDMS policy).\n\n"
+		"-u      Only test one priority permutation of each class of\n"
+		"        permutations that give the same schedulability.\n\n"
+		"-f      Reject combinations of phase change points that provably\n"
+		"        miss a deadline with cheap tests before simulating them.\n\n"
+		"-m      Reject combinations of phase change points in which the\n"
+		"        tasks of highest priority miss a deadline on their own,\n"
+		"        caching the verdicts of such subsets of the tasks.\n\n"
+		"-b      Bisect the phase change points of T2..T4, guided by the\n"
+		"        first task to miss a deadline, instead of testing all\n"
+		"        of them (experimental, no proof of unschedulability,\n"
+		"        not combined with -p, -s, -f or -m). In a sweep, also\n"
+		"        bisect those of all tasks when FDMS fails.\n\n"
+		"-w      When no priority permutations are left, let idle workers\n"
+		"        take over half of the phase change points of T1 that\n"
+		"        another worker has left.\n\n";
+	char *more_options_help = \
+		"--checkpoint FILE\n"
+		"        Periodically save the progress of tests 1 and 2 to FILE.\n\n"
+		"--checkpoint-interval SECONDS\n"
+		"        Time between checkpoints (default 60).\n\n"
+		"--resume FILE\n"
+		"        Continue test 1 or 2 from the checkpoint in FILE (which is\n"
+		"        also used for further checkpoints, unless --checkpoint is\n"
+		"        given). Use the same options as in the original run.\n\n"
+		"--shard K/N\n"
+		"        Only test the priority permutations of tests 1 and 2 whose\n"
+		"        index is K modulo N (0 <= K < N), and print a RESULT line\n"
+		"        for merging the results of all N shards.\n\n"
+		"--output LEVEL\n"
+		"        How much the searches print, one of:\n"
+		"        silent    only the final verdict\n"
+		"        progress  periodic progress summaries (default)\n"
+		"        full      every tested priority permutation\n\n"
+		"--progress-interval SECONDS\n"
+		"        Time between progress summaries (default 10).\n\n"
+		"--order ORDER\n"
+		"        Test the phase change points of each task in ORDER, to\n"
+		"        find schedulable ones sooner (not combined with -p, -b\n"
+		"        or the simd and gpu engines), which is one of:\n"
+		"        up      from 0 up to the period (default)\n"
+		"        center  outwards from half the period\n"
+		"        ranked  outwards from both the WCET and half the period\n"
+		"        fdms    outwards from the phase change points that the\n"
+		"                FDMS policy ends at\n\n"
+		"--numa-local\n"
+		"        Pad the context of each worker to whole pages, so that\n"
+		"        it is allocated on the NUMA node of the worker.\n\n"
+		"--trace-buffer MIB\n"
+		"        Size of the ring buffer of the trace command (default\n"
+		"        64), beyond which the oldest events are dropped.\n\n"
+		"--max-hyper-period N\n"
+		"        Do not simulate task sets with a hyper-period over N:\n"
+		"        skip them in a sweep, and refuse them in the search and\n"
+		"        trace commands (default: any that fits in a long).\n\n"
+		"--json FILE\n"
+		"        Write one JSON record per finished priority permutation of\n"
+		"        tests 1 and 2, any witness and the result to FILE.\n\n"
+		"--status FILE\n"
+		"        Every --progress-interval seconds, write the progress,\n"
+		"        throughput and ETA of the searches over priority\n"
+		"        permutations to FILE (or to standard error if FILE is -).\n\n"
+		"--metrics FILE\n"
+		"        Also write them as Prometheus metrics to FILE.\n";
+	printf("%s%s%s", help, options_help, more_options_help);
 	exit(EXIT_FAILURE);
 }
 
+/*
+ * Exit with the help if the options combine searches that the help documents
+ * as not combined. permutation_worker() would otherwise silently pick one of
+ * them (-b before -p before simd before gpu before --order).
+ */
+void check_option_combinations() {
+	const char *conflict = NULL;
+	int simd = options.engine == ENGINE_SIMD;
+	int gpu = options.engine == ENGINE_GPU;
+	if (simd && options.prune) {
+		conflict = "-e simd with -p";
+	} else if (gpu && (options.prune || options.prefilter ||
+				options.memoize || options.snapshots)) {
+		conflict = "-e gpu with -p, -f, -m or -s";
+	} else if (options.bisect && (options.prune || options.snapshots ||
+				options.prefilter || options.memoize)) {
+		conflict = "-b with -p, -s, -f or -m";
+	} else if (options.order != ORDER_UP && (options.prune ||
+				options.bisect || simd || gpu)) {
+		conflict = "--order with -p, -b or the simd and gpu engines";
+	}
+	if (conflict != NULL) {
+		fprintf(stderr, "Cannot combine %s.\n\n", conflict);
+		print_help_and_exit();
+	}
+}
+
 int main(int argc, char **argv) {
+	char **args = xmalloc(argc * sizeof(char *)); /* TEST_NUM or COMMAND ARGS */
+	int num_args = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (strcmp(argv[i], "-j") == 0 && i + 1 < argc) {
+			options.num_threads = atoi(argv[++i]);
+			if (options.num_threads < 1 || options.num_threads > MAX_THREADS) {
+				print_help_and_exit();
+			}
+		} else if (strcmp(argv[i], "-p") == 0) {
+			options.prune = 1;
+		} else if (strcmp(argv[i], "-s") == 0) {
+			options.snapshots = 1;
+		} else if (strcmp(argv[i], "-u") == 0) {
+			options.unique = 1;
+		} else if (strcmp(argv[i], "-f") == 0) {
+			options.prefilter = 1;
+		} else if (strcmp(argv[i], "-m") == 0) {
+			options.memoize = 1;
+		} else if (strcmp(argv[i], "-b") == 0) {
+			options.bisect = 1;
+		} else if (strcmp(argv[i], "-w") == 0) {
+			options.steal = 1;
+		} else if (strcmp(argv[i], "--checkpoint") == 0 && i + 1 < argc) {
+			options.checkpoint_file = argv[++i];
+		} else if (strcmp(argv[i], "--checkpoint-interval") == 0 &&
+				i + 1 < argc) {
+			options.checkpoint_interval = atoi(argv[++i]);
+			if (options.checkpoint_interval < 1) {
+				print_help_and_exit();
+			}
+		} else if (strcmp(argv[i], "--resume") == 0 && i + 1 < argc) {
+			options.resume_file = argv[++i];
+		} else if (strcmp(argv[i], "--shard") == 0 && i + 1 < argc) {
+			char end;
+			if (sscanf(argv[++i], "%d/%d%c", &options.shard,
+						&options.num_shards, &end) != 2 ||
+					options.num_shards < 1 || options.shard < 0 ||
+					options.shard >= options.num_shards) {
+				print_help_and_exit();
+			}
+		} else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "silent") == 0) {
+				options.output = OUTPUT_SILENT;
+			} else if (strcmp(argv[i], "progress") == 0) {
+				options.output = OUTPUT_PROGRESS;
+			} else if (strcmp(argv[i], "full") == 0) {
+				options.output = OUTPUT_FULL;
+			} else {
+				print_help_and_exit();
+			}
+		} else if (strcmp(argv[i], "--progress-interval") == 0 &&
+				i + 1 < argc) {
+			options.progress_interval = atoi(argv[++i]);
+			if (options.progress_interval < 1) {
+				print_help_and_exit();
+			}
+		} else if (strcmp(argv[i], "--order") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "up") == 0) {
+				options.order = ORDER_UP;
+			} else if (strcmp(argv[i], "center") == 0) {
+				options.order = ORDER_CENTER;
+			} else if (strcmp(argv[i], "ranked") == 0) {
+				options.order = ORDER_RANKED;
+			} else if (strcmp(argv[i], "fdms") == 0) {
+				options.order = ORDER_FDMS;
+			} else {
+				print_help_and_exit();
+			}
+		} else if (strcmp(argv[i], "--numa-local") == 0) {
+			options.numa_local = 1;
+		} else if (strcmp(argv[i], "--trace-buffer") == 0 && i + 1 < argc) {
+			options.trace_buffer_size = atoi(argv[++i]);
+			if (options.trace_buffer_size < 1 ||
+					options.trace_buffer_size > 4096) {
+				print_help_and_exit();
+			}
+		} else if (strcmp(argv[i], "--max-hyper-period") == 0 &&
+				i + 1 < argc) {
+			options.max_hyper_period = atol(argv[++i]);
+			if (options.max_hyper_period < 1) {
+				print_help_and_exit();
+			}
+		} else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+			options.json_file = argv[++i];
+		} else if (strcmp(argv[i], "--status") == 0 && i + 1 < argc) {
+			options.status_file = argv[++i];
+		} else if (strcmp(argv[i], "--metrics") == 0 && i + 1 < argc) {
+			options.metrics_file = argv[++i];
+		} else if (strcmp(argv[i], "-e") == 0 && i + 1 < argc) {
+			i++;
+			if (strcmp(argv[i], "tick") == 0) {
+				options.engine = ENGINE_TICK;
+			} else if (strcmp(argv[i], "event") == 0) {
+				options.engine = ENGINE_EVENT;
+			} else if (strcmp(argv[i], "table") == 0) {
+				options.engine = ENGINE_TABLE;
+			} else if (strcmp(argv[i], "compact") == 0) {
+				options.engine = ENGINE_COMPACT;
+			} else if (strcmp(argv[i], "simd") == 0) {
+				options.engine = ENGINE_SIMD;
+			} else if (strcmp(argv[i], "countdown") == 0) {
+				options.engine = ENGINE_COUNTDOWN;
+			} else if (strcmp(argv[i], "gpu") == 0) {
+#if OPENCL
+				options.engine = ENGINE_GPU;
+#else
+				fprintf(stderr, "The gpu engine needs make OPENCL=1.\n");
+				exit(EXIT_FAILURE);
+#endif
+			} else {
+				print_help_and_exit();
+			}
+		} else if (argv[i][0] == '-' && num_args == 0) {
+			print_help_and_exit();
+		} else {
+			args[num_args] = argv[i];
+			num_args++;
+		}
+	}
+
+	if (num_args == 0) {
+		print_help_and_exit();
+	}
+	check_option_combinations();
+	if (options.resume_file != NULL && options.checkpoint_file == NULL) {
+		options.checkpoint_file = options.resume_file;
+	}
 
-	if (argc != 2) {
+	if (strcmp(args[0], "search") == 0) {
+		run_generic_search(args + 1, num_args - 1);
+		return EXIT_SUCCESS;
+	} else if (strcmp(args[0], "selfcheck") == 0 && num_args == 1) {
+		run_selfcheck();
+		return EXIT_SUCCESS;
+	} else if (strcmp(args[0], "bench") == 0) {
+		run_benchmark(args + 1, num_args - 1);
+		return EXIT_SUCCESS;
+	} else if (strcmp(args[0], "scaling") == 0) {
+		run_scaling_benchmark(args + 1, num_args - 1);
+		return EXIT_SUCCESS;
+	} else if (strcmp(args[0], "sweep") == 0) {
+		run_sweep(args + 1, num_args - 1);
+		return EXIT_SUCCESS;
+	} else if (strcmp(args[0], "trace") == 0) {
+		run_trace(args + 1, num_args - 1);
+		return EXIT_SUCCESS;
+	} else if (strcmp(args[0], "certify") == 0) {
+		run_certify(args + 1, num_args - 1);
+		return EXIT_SUCCESS;
+	} else if (strcmp(args[0], "recheck") == 0) {
+		run_recheck(args + 1, num_args - 1);
+		return EXIT_SUCCESS;
+	} else if (strcmp(args[0], "decode") == 0 && num_args >= 2) {
+		run_decode(args + 1, num_args - 1);
+		return EXIT_SUCCESS;
+	} else if (num_args != 1) {
 		print_help_and_exit();
 	}
 
-	switch (atoi(argv[1])) {
+	switch (atoi(args[0])) {
 		case 1:
 			verify_counterexample_1();
 			break;